@@ -8,8 +8,11 @@
 #endif
 
 #include <iostream>
+#include <numeric>
 #include <vector>
 
+#include "harness.h"
+
 using Integer = unsigned long long;
 
 template <class A, class B> void AssertEqual(const A &a, const B &b) {
@@ -72,6 +75,36 @@ void EasyCustomRangeLoop(benchmark::State &state) {
 
 BENCHMARK(EasyCustomRangeLoop);
 
+Integer __attribute__((noinline)) easyCustomGeneratorLoop(Integer max) {
+  struct CustomRangeGenerator : public easy_iterator::InitializedIterable {
+    Integer current, max;
+
+    explicit CustomRangeGenerator(Integer end) : current(0), max(end) {}
+
+    bool init() { return current != max; }
+    bool advance() { return ++current != max; }
+    Integer value() const noexcept { return current; }
+    size_t sizeHint() const { return max - current; }
+  };
+
+  Integer result = 0;
+  for (auto i : easy_iterator::MakeGenerator<CustomRangeGenerator>(max + 1)) {
+    result += i;
+  }
+
+  return result;
+}
+
+void EasyCustomGeneratorLoop(benchmark::State &state) {
+  Integer max = 10000;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(max);
+    AssertEqual(easyCustomGeneratorLoop(max), max * (max + 1) / 2);
+  }
+}
+
+BENCHMARK(EasyCustomGeneratorLoop);
+
 #ifdef COMPARE_WITH_ITERTOOLS
 
 Integer __attribute__((noinline)) iterRangeLoop(Integer max) {
@@ -287,4 +320,55 @@ void ManualEnumerateIteration(benchmark::State &state) {
 
 BENCHMARK(ManualEnumerateIteration);
 
+struct CountingGenerator : public easy_iterator::InitializedIterable {
+  Integer current = 0, max;
+
+  explicit CountingGenerator(Integer end) : max(end) {}
+
+  bool init() { return current != max; }
+  bool advance() { return ++current != max; }
+  Integer value() const noexcept { return current; }
+};
+
+static const bool harnessRegistered = []() {
+  using namespace easy_iterator;
+
+  harness::compare(
+      "Range", [](size_t n) { return range(Integer(n)); },
+      [](size_t n) {
+        Integer result = 0;
+        for (Integer i = 0; i < n; ++i) {
+          result += i;
+        }
+        return result;
+      });
+
+  harness::compare(
+      "Generator", [](size_t n) { return MakeGenerator<CountingGenerator>(Integer(n)); },
+      [](size_t n) {
+        Integer result = 0;
+        for (Integer i = 0; i < n; ++i) {
+          result += i;
+        }
+        return result;
+      });
+
+  static std::vector<Integer> values(harness::defaultSizes().back());
+  std::iota(values.begin(), values.end(), 0);
+
+  harness::compare(
+      "InclusiveScan",
+      [](size_t n) { return inclusiveScan(valuesBetween(values.data(), values.data() + n)); },
+      [](size_t n) {
+        Integer total = 0, result = 0;
+        for (size_t i = 0; i < n; ++i) {
+          total += values[i];
+          result += total;
+        }
+        return result;
+      });
+
+  return true;
+}();
+
 BENCHMARK_MAIN();
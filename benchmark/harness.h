@@ -0,0 +1,229 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include) && !defined(EASY_ITERATOR_NO_PERF_COUNTERS)
+#  if __has_include(<linux/perf_event.h>)
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    define EASY_ITERATOR_HAS_PERF_COUNTERS
+#  endif
+#endif
+
+/**
+ * Reusable harness comparing iterables against handwritten baselines.
+ */
+namespace harness {
+
+  /**
+   * Default reduction of an iterable: the sum of its elements.
+   */
+  struct Sum {
+    template <class T> auto operator()(T &&iterable) const {
+      std::decay_t<decltype(*std::begin(iterable))> result{};
+      for (auto &&value : iterable) {
+        result += value;
+      }
+      return result;
+    }
+  };
+
+  /**
+   * Hardware event counters of the calling thread, read through `perf_event_open` on Linux.
+   * The counters form a single group led by the cycle counter, so that they are scheduled onto
+   * the PMU together and count over the same interval. If the kernel multiplexes the group with
+   * other events, the counts are scaled by the fraction of time it was running. Counters that
+   * can not be opened, e.g. due to `perf_event_paranoid` or inside virtual machines, are
+   * reported as unavailable.
+   */
+  class PerfCounters {
+  public:
+    enum Event { cycles, instructions, cacheMisses, eventCount };
+
+  private:
+    int descriptors[eventCount] = {-1, -1, -1};
+    // position of every event in the group, in the order the events were added
+    size_t positions[eventCount] = {};
+    int leader = -1;
+    uint64_t values[eventCount] = {};
+
+#ifdef EASY_ITERATOR_HAS_PERF_COUNTERS
+    static int open(uint64_t config, int group) {
+      perf_event_attr attributes{};
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.size = sizeof(attributes);
+      attributes.config = config;
+      // members follow the state of the leader
+      attributes.disabled = group < 0;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                               | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return int(syscall(__NR_perf_event_open, &attributes, 0, -1, group, 0));
+    }
+#endif
+
+  public:
+    PerfCounters() {
+#ifdef EASY_ITERATOR_HAS_PERF_COUNTERS
+      const uint64_t configs[eventCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                            PERF_COUNT_HW_CACHE_MISSES};
+      size_t members = 0;
+      // the first counter that can be opened leads the group, normally the cycle counter
+      for (int event = 0; event < eventCount; ++event) {
+        descriptors[event] = open(configs[event], leader);
+        if (descriptors[event] >= 0) {
+          positions[event] = members++;
+          if (leader < 0) {
+            leader = descriptors[event];
+          }
+        }
+      }
+#endif
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters() {
+#ifdef EASY_ITERATOR_HAS_PERF_COUNTERS
+      for (auto descriptor : descriptors) {
+        if (descriptor >= 0) {
+          close(descriptor);
+        }
+      }
+#endif
+    }
+
+    bool available(Event event) const { return descriptors[event] >= 0; }
+
+    void start() {
+#ifdef EASY_ITERATOR_HAS_PERF_COUNTERS
+      if (leader >= 0) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      }
+#endif
+    }
+
+    void stop() {
+#ifdef EASY_ITERATOR_HAS_PERF_COUNTERS
+      if (leader < 0) {
+        return;
+      }
+      ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      // layout for PERF_FORMAT_GROUP: count, time enabled, time running, then one value per
+      // member
+      uint64_t buffer[3 + eventCount] = {};
+      auto size = read(leader, buffer, sizeof(buffer));
+      uint64_t members = buffer[0], enabled = buffer[1], running = buffer[2];
+      bool valid = size >= ssize_t(3 * sizeof(uint64_t))
+                   && size_t(size) == (3 + members) * sizeof(uint64_t) && running > 0;
+      for (int event = 0; event < eventCount; ++event) {
+        values[event] = 0;
+        if (valid && descriptors[event] >= 0) {
+          auto count = buffer[3 + positions[event]];
+          values[event] = running < enabled
+                              ? uint64_t(double(count) * double(enabled) / double(running))
+                              : count;
+        }
+      }
+#endif
+    }
+
+    /**
+     * The count of `event` between the last calls to `start()` and `stop()`, extrapolated to the
+     * whole interval if the counters were multiplexed.
+     */
+    uint64_t value(Event event) const { return values[event]; }
+  };
+
+  /**
+   * Runs the benchmark loop of `state`, calling `f(elements)` in every iteration, and reports
+   * the time per element as well as the instructions per cycle and cache misses per element if
+   * available.
+   */
+  template <class F> void measure(benchmark::State &state, size_t elements, F &&f) {
+    PerfCounters counters;
+    uint64_t iterations = 0;
+    counters.start();
+    auto start = std::chrono::steady_clock::now();
+    for (auto _ : state) {
+      // hide the size from the optimizer, so that results can not be reused between iterations
+      auto size = elements;
+      benchmark::DoNotOptimize(size);
+      auto result = f(size);
+      benchmark::DoNotOptimize(result);
+      ++iterations;
+    }
+    auto end = std::chrono::steady_clock::now();
+    counters.stop();
+
+    double processed = double(iterations) * double(elements);
+    if (processed == 0) {
+      return;
+    }
+    state.counters["ns/element"]
+        = std::chrono::duration<double, std::nano>(end - start).count() / processed;
+    using Event = PerfCounters::Event;
+    if (counters.available(Event::cycles) && counters.available(Event::instructions)
+        && counters.value(Event::cycles) > 0) {
+      state.counters["IPC"] = double(counters.value(Event::instructions))
+                              / double(counters.value(Event::cycles));
+    }
+    if (counters.available(Event::cacheMisses)) {
+      state.counters["misses/element"] = double(counters.value(Event::cacheMisses)) / processed;
+    }
+  }
+
+  /**
+   * The default element counts used by `compare()`.
+   */
+  inline std::vector<size_t> defaultSizes() { return {1 << 10, 1 << 16, 1 << 22}; }
+
+  /**
+   * Registers two benchmarks for every size `n` in `sizes`: `<name>/Easy/<n>` consuming the
+   * iterable returned by `factory(n)` with `reduce`, and `<name>/Baseline/<n>` calling the
+   * handwritten `baseline(n)`, which must return the same result. Results are compared before
+   * measuring, and both benchmarks fail if they differ.
+   */
+  template <class Factory, class Baseline, class Reduce = Sum>
+  void compare(const std::string &name, Factory factory, Baseline baseline,
+               const std::vector<size_t> &sizes = defaultSizes(), Reduce reduce = Reduce()) {
+    auto check = [=](benchmark::State &state, size_t n) {
+      if (!(reduce(factory(n)) == baseline(n))) {
+        state.SkipWithError("result differs from baseline");
+        return false;
+      }
+      return true;
+    };
+    auto easy
+        = benchmark::RegisterBenchmark((name + "/Easy").c_str(), [=](benchmark::State &state) {
+            auto n = size_t(state.range(0));
+            if (check(state, n)) {
+              measure(state, n, [&](size_t size) { return reduce(factory(size)); });
+            }
+          });
+    auto handwritten
+        = benchmark::RegisterBenchmark((name + "/Baseline").c_str(), [=](benchmark::State &state) {
+            auto n = size_t(state.range(0));
+            if (check(state, n)) {
+              measure(state, n, [&](size_t size) { return baseline(size); });
+            }
+          });
+    for (auto n : sizes) {
+      easy->Arg(int64_t(n));
+      handwritten->Arg(int64_t(n));
+    }
+  }
+
+}  // namespace harness
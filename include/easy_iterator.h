@@ -1,11 +1,72 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#if !defined(__GNUC__) && !defined(__clang__) && defined(_MSC_VER)
+#  include <intrin.h>
+#  if defined(_M_X64) || defined(_M_IX86)
+#    define EASY_ITERATOR_HAS_MM_PREFETCH
+#  endif
+#  if defined(_M_X64) || defined(_M_ARM64)
+#    define EASY_ITERATOR_HAS_BIT_SCAN_FORWARD_64
+#  endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define EASY_ITERATOR_HAS_STREAMING_STORES
+#endif
+
+/**
+ * Placed before short fixed-length inner loops that should be vectorized. Keeps GCC from fully
+ * unrolling them first, which would leave only scalar code.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#  define EASY_ITERATOR_VECTORIZE_LOOP _Pragma("GCC unroll 1")
+#else
+#  define EASY_ITERATOR_VECTORIZE_LOOP
+#endif
+
+/**
+ * Enables runtime checks for common iterator misuse, such as zipping iterables of different
+ * lengths or reusing single-use iterables. Has no overhead when disabled.
+ * The checks change the layout of iterable types, so the setting must be the same in every
+ * translation unit of a program. Mismatches are reported by the linker on MSVC.
+ */
+#ifndef EASY_ITERATOR_DEBUG
+#  define EASY_ITERATOR_DEBUG 0
+#endif
+
+#ifdef _MSC_VER
+#  if EASY_ITERATOR_DEBUG
+#    pragma detect_mismatch("EASY_ITERATOR_DEBUG", "1")
+#  else
+#    pragma detect_mismatch("EASY_ITERATOR_DEBUG", "0")
+#  endif
+#endif
 
 namespace easy_iterator {
 
@@ -13,32 +74,171 @@ namespace easy_iterator {
    * The end state for self-contained iterators.
    */
   struct IterationEnd {
-    const IterationEnd &operator*() const { return *this; }
+    constexpr const IterationEnd &operator*() const { return *this; }
+  };
+
+  /**
+   * Exception in debug mode when iterables of different lengths are traversed by `zip`.
+   */
+  struct ZipLengthMismatchException : public std::exception {
+    const char *what() const noexcept override { return "zipped iterables differ in length"; }
+  };
+
+  /**
+   * Exception in debug mode when a single-use iterable is traversed a second time.
+   */
+  struct ReusedIterableException : public std::exception {
+    const char *what() const noexcept override {
+      return "attempt to iterate over a single-use iterable twice";
+    }
+  };
+
+  /**
+   * Exception in debug mode when dereferencing an iterator outside of its range, or creating a
+   * view of elements outside of the underlying range.
+   */
+  struct OutOfRangeIteratorException : public std::exception {
+    const char *what() const noexcept override {
+      return "attempt to dereference an iterator outside of its range";
+    }
+  };
+
+  /**
+   * Exception in debug mode when a key function returns a bin outside of the valid range.
+   */
+  struct OutOfRangeKeyException : public std::exception {
+    const char *what() const noexcept override { return "key outside of the range of bins"; }
+  };
+
+  /**
+   * Exception when the number of elements of a combinatorial sequence exceeds the range of
+   * `size_t`.
+   */
+  struct SizeOverflowException : public std::exception {
+    const char *what() const noexcept override {
+      return "number of elements exceeds the range of size_t";
+    }
   };
 
+  namespace iterator_detail {
+    constexpr bool debug = EASY_ITERATOR_DEBUG;
+
+    template <class A, class B, class = void> struct IsEqualityComparable : std::false_type {};
+
+    template <class A, class B> struct IsEqualityComparable<
+        A, B, std::void_t<decltype(std::declval<const A &>() == std::declval<const B &>())>>
+        : std::true_type {};
+
+    /**
+     * Tracks in debug mode whether a single-use iterable has been consumed.
+     */
+    template <bool SingleUse = true, bool Enabled = debug && SingleUse> struct UseTracker {
+      constexpr void markUsed() {}
+    };
+
+    template <bool SingleUse> struct UseTracker<SingleUse, true> {
+      bool used = false;
+      constexpr void markUsed() {
+        if (used) {
+          throw ReusedIterableException();
+        }
+        used = true;
+      }
+    };
+
+    template <class T> using BeginType = std::decay_t<decltype(std::begin(std::declval<T &>()))>;
+    template <class T> using EndType = std::decay_t<decltype(std::end(std::declval<T &>()))>;
+
+    template <class T, class = void> struct HasSize : std::false_type {};
+
+    template <class T> struct HasSize<T, std::void_t<decltype(std::declval<T &>().size())>>
+        : std::true_type {};
+
+    /**
+     * True for non-owning views, whose iterators stay valid after the view is destroyed.
+     */
+    template <class T> struct IsView : std::false_type {};
+
+    /**
+     * True for temporary containers, whose iterators dangle once the full expression ends.
+     */
+    template <class T> static constexpr bool isTemporaryContainer
+        = !std::is_lvalue_reference<T>::value && HasSize<std::remove_reference_t<T>>::value
+          && !IsView<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+    template <class... Args> constexpr void checkNoTemporaryContainers() {
+      static_assert(!debug || !(isTemporaryContainer<Args> || ...),
+                    "iterating over a temporary container, its iterators will dangle");
+    }
+
+    /**
+     * Removes overloads for temporary containers from functions whose result keeps iterators into
+     * their arguments, which would dangle in release mode as well.
+     */
+    template <class... Args> using NoTemporaryContainers
+        = std::enable_if_t<!(isTemporaryContainer<Args> || ...)>;
+
+    /**
+     * Dereferences a pointer after checking that it lies within `[begin, end)`.
+     */
+    template <class T> struct BoundsCheckedDereference {
+      T *begin, *end;
+      constexpr T &operator()(T *value) const {
+        if (value < begin || value >= end) {
+          throw OutOfRangeIteratorException();
+        }
+        return *value;
+      }
+    };
+  }  // namespace iterator_detail
+
   /**
    * Helper functions for comparing iterators.
    */
   namespace compare {
 
     struct ByValue {
-      template <class T> bool operator()(const T &a, const T &b) const { return a == b; }
+      template <class T> constexpr bool operator()(const T &a, const T &b) const { return a == b; }
     };
 
     struct ByAddress {
-      template <class T> bool operator()(const T &a, const T &b) const { return &a == &b; }
+      template <class T> constexpr bool operator()(const T &a, const T &b) const {
+        return &a == &b;
+      }
     };
 
     struct ByLastTupleElementMatch {
       template <typename... ArgsA, typename... ArgsB>
-      bool operator()(const std::tuple<ArgsA...> &a, const std::tuple<ArgsB...> &b) const {
+      constexpr bool operator()(const std::tuple<ArgsA...> &a,
+                                const std::tuple<ArgsB...> &b) const {
         static_assert(sizeof...(ArgsA) == sizeof...(ArgsB), "comparing invalid tuples");
-        return std::get<sizeof...(ArgsA) - 1>(a) == std::get<sizeof...(ArgsB) - 1>(b);
+        bool result = std::get<sizeof...(ArgsA) - 1>(a) == std::get<sizeof...(ArgsB) - 1>(b);
+        if constexpr (iterator_detail::debug) {
+          checkElements(result, a, b, std::make_index_sequence<sizeof...(ArgsA) - 1>());
+        }
+        return result;
+      }
+
+      // every element that can be compared must reach its end together with the last one
+      template <class A, class B, size_t... Idx>
+      constexpr void checkElements(bool result, const A &a, const B &b,
+                                   std::index_sequence<Idx...>) const {
+        [[maybe_unused]] auto check = [result](const auto &x, const auto &y) {
+          if constexpr (iterator_detail::IsEqualityComparable<std::decay_t<decltype(x)>,
+                                                              std::decay_t<decltype(y)>>::value) {
+            if ((x == y) != result) {
+              throw ZipLengthMismatchException();
+            }
+          }
+        };
+        (check(std::get<Idx>(a), std::get<Idx>(b)), ...);
       }
     };
 
     struct Never {
-      template <class A, class B> bool operator()(const A &, const B &) const { return false; }
+      template <class A, class B> constexpr bool operator()(const A &, const B &) const {
+        return false;
+      }
     };
   }  // namespace compare
 
@@ -47,22 +247,23 @@ namespace easy_iterator {
    */
   namespace increment {
     template <int A> struct ByValue {
-      template <class T> void operator()(T &v) const { v = v + A; }
+      template <class T> constexpr void operator()(T &v) const { v = v + A; }
     };
 
     struct ByTupleIncrement {
-      template <typename... Args> void dummy(Args &&...) {}
-      template <class T, size_t... Idx> void updateValues(T &v, std::index_sequence<Idx...>) {
+      template <typename... Args> constexpr void dummy(Args &&...) {}
+      template <class T, size_t... Idx>
+      constexpr void updateValues(T &v, std::index_sequence<Idx...>) {
         dummy(++std::get<Idx>(v)...);
       }
-      template <typename... Args> void operator()(std::tuple<Args...> &v) {
+      template <typename... Args> constexpr void operator()(std::tuple<Args...> &v) {
         updateValues(v, std::make_index_sequence<sizeof...(Args)>());
       }
     };
 
     template <typename T, typename M, M Method> struct ByMemberCall {
       using R = decltype((std::declval<T &>().*Method)());
-      R operator()(T &v) const { return (v.*Method)(); }
+      constexpr R operator()(T &v) const { return (v.*Method)(); }
     };
 
   }  // namespace increment
@@ -72,41 +273,38 @@ namespace easy_iterator {
    */
   namespace dereference {
     struct ByValue {
-      template <class T> T operator()(T &v) const { return v; }
+      template <class T> constexpr T operator()(T &v) const { return v; }
     };
 
     struct ByConstValueReference {
-      template <class T> const T &operator()(T &v) const { return v; }
+      template <class T> constexpr const T &operator()(T &v) const { return v; }
     };
 
     struct ByValueReference {
-      template <class T> T &operator()(T &v) const { return v; }
+      template <class T> constexpr T &operator()(T &v) const { return v; }
     };
 
     struct ByValueDereference {
-      template <class T> auto &operator()(T &v) const { return *v; }
+      template <class T> constexpr auto &operator()(T &v) const { return *v; }
     };
 
     struct ByTupleDereference {
-      template <size_t Idx, class T> auto constexpr getElement(T &v) const {
-        if constexpr (std::is_reference<decltype(*std::get<Idx>(v))>::value) {
-          return std::reference_wrapper(*std::get<Idx>(v));
-        } else {
-          return *std::get<Idx>(v);
-        }
-      }
-      template <size_t... Idx, class T>
-      auto getReferenceTuple(T &v, std::index_sequence<Idx...>) const {
-        return std::make_tuple(getElement<Idx>(v)...);
+      // references are kept as references, values are stored by value
+      template <class I> using ElementType = std::conditional_t<
+          std::is_lvalue_reference<decltype(*std::declval<I &>())>::value,
+          decltype(*std::declval<I &>()), std::decay_t<decltype(*std::declval<I &>())>>;
+      template <size_t... Idx, class... Args>
+      constexpr auto getReferenceTuple(std::tuple<Args...> &v, std::index_sequence<Idx...>) const {
+        return std::tuple<ElementType<Args>...>(*std::get<Idx>(v)...);
       }
-      template <typename... Args> auto operator()(std::tuple<Args...> &v) const {
+      template <typename... Args> constexpr auto operator()(std::tuple<Args...> &v) const {
         return getReferenceTuple(v, std::make_index_sequence<sizeof...(Args)>());
       }
     };
 
     template <typename T, typename M, M Method> struct ByMemberCall {
       using R = decltype((std::declval<T &>().*Method)());
-      R operator()(T &v) const { return (v.*Method)(); }
+      constexpr R operator()(T &v) const { return (v.*Method)(); }
     };
 
   }  // namespace dereference
@@ -149,32 +347,35 @@ namespace easy_iterator {
 
     IteratorPrototype() = delete;
     template <class F, class AD = D, class AC = C>
-    explicit IteratorPrototype(F &&first, AD &&_dereferencer = D(), AC &&_compare = C())
+    constexpr explicit IteratorPrototype(F &&first, AD &&_dereferencer = D(),
+                                         AC &&_compare = C())
         : dereferencer(std::forward<AD>(_dereferencer)),
           compare(std::forward<AC>(_compare)),
           value(std::forward<F>(first)) {}
 
-    DereferencedType operator*() { return dereferencer(value); }
-    auto *operator->() const { return &**this; }
+    constexpr DereferencedType operator*() { return dereferencer(value); }
+    constexpr auto *operator->() const { return &**this; }
 
     template <typename... LArgs, typename... RArgs>
-    friend bool operator==(const IteratorPrototype<LArgs...> &lhs,
-                           const IteratorPrototype<RArgs...> &rhs);
+    friend constexpr bool operator==(const IteratorPrototype<LArgs...> &lhs,
+                                     const IteratorPrototype<RArgs...> &rhs);
 
     // required for C++17 or earlier
     template <typename... LArgs, typename... RArgs>
-    friend bool operator!=(const IteratorPrototype<LArgs...> &lhs,
-                           const IteratorPrototype<RArgs...> &rhs);
+    friend constexpr bool operator!=(const IteratorPrototype<LArgs...> &lhs,
+                                     const IteratorPrototype<RArgs...> &rhs);
   };
 
   template <typename... LArgs, typename... RArgs>
-  bool operator==(const IteratorPrototype<LArgs...> &lhs, const IteratorPrototype<RArgs...> &rhs) {
+  constexpr bool operator==(const IteratorPrototype<LArgs...> &lhs,
+                            const IteratorPrototype<RArgs...> &rhs) {
     return lhs.compare(lhs.value, rhs.value);
   }
 
   // required for C++17 or earlier
   template <typename... LArgs, typename... RArgs>
-  bool operator!=(const IteratorPrototype<LArgs...> &lhs, const IteratorPrototype<RArgs...> &rhs) {
+  constexpr bool operator!=(const IteratorPrototype<LArgs...> &lhs,
+                            const IteratorPrototype<RArgs...> &rhs) {
     return !(lhs == rhs);
   }
 
@@ -213,12 +414,12 @@ namespace easy_iterator {
 
   public:
     template <typename TT, typename TF = F, typename TD = D, typename TC = C>
-    explicit Iterator(TT &&begin, TF &&_callback = F(), TD &&_dereferencer = D(),
-                      TC &&_compare = C())
+    constexpr explicit Iterator(TT &&begin, TF &&_callback = F(), TD &&_dereferencer = D(),
+                                TC &&_compare = C())
         : IteratorPrototype<T, D, C>(std::forward<TT>(begin), std::forward<TD>(_dereferencer),
                                      std::forward<TC>(_compare)),
           callback(_callback) {}
-    Iterator &operator++() {
+    constexpr Iterator &operator++() {
       if constexpr (Iterator::hasState) {
         if (Iterator::state) {
           Iterator::state = callback(Base::value);
@@ -228,7 +429,7 @@ namespace easy_iterator {
       }
       return *this;
     }
-    typename Base::DereferencedType operator*() {
+    constexpr typename Base::DereferencedType operator*() {
       if constexpr (Iterator::hasState) {
         if (!Iterator::state) {
           throw UndefinedIteratorException();
@@ -238,12 +439,12 @@ namespace easy_iterator {
     }
 
     template <typename... Args>
-    friend bool operator==(const Iterator<Args...> &lhs, const IterationEnd &);
+    friend constexpr bool operator==(const Iterator<Args...> &lhs, const IterationEnd &);
     // required for C++17 or earlier
     template <typename... Args>
-    friend bool operator!=(const Iterator<Args...> &lhs, const IterationEnd &);
+    friend constexpr bool operator!=(const Iterator<Args...> &lhs, const IterationEnd &);
 
-    explicit operator bool() const {
+    constexpr explicit operator bool() const {
       if constexpr (Iterator::hasState) {
         return Iterator::state;
       } else {
@@ -252,13 +453,14 @@ namespace easy_iterator {
     }
   };
 
-  template <typename... Args> bool operator==(const Iterator<Args...> &lhs, const IterationEnd &) {
+  template <typename... Args>
+  constexpr bool operator==(const Iterator<Args...> &lhs, const IterationEnd &) {
     return !static_cast<bool>(lhs);
   }
 
   // required for C++17 or earlier
   template <typename... Args>
-  bool operator!=(const Iterator<Args...> &lhs, const IterationEnd &rhs) {
+  constexpr bool operator!=(const Iterator<Args...> &lhs, const IterationEnd &rhs) {
     return !(lhs == rhs);
   }
 
@@ -274,7 +476,7 @@ namespace easy_iterator {
 
   template <class T, typename F = increment::ByValue<1>, typename D = dereference::ByValueReference,
             typename C = compare::ByValue>
-  Iterator<T, F, D, C> makeIterator(T &&t, F f = F(), D &&d = D(), C &&c = C()) {
+  constexpr Iterator<T, F, D, C> makeIterator(T &&t, F f = F(), D &&d = D(), C &&c = C()) {
     return Iterator<T, F, D, C>(t, f, d, c);
   }
 
@@ -284,23 +486,93 @@ namespace easy_iterator {
   template <class T, class A = increment::ByValue<1>> using ReferenceIterator
       = Iterator<T *, A, dereference::ByValueDereference>;
 
+  template <class T> struct RangeIterator;
+  template <class T> class GeneratorIterator;
+
   /**
-   * Helper class for `wrap()`.
+   * When used as a base class for an iterator type, `MakeIterable` and `MakeGenerator` start every
+   * traversal from a copy of the initial state. Only valid if copies of the state can be advanced
+   * independently.
    */
-  template <class IB, class IE = IB> struct WrappedIterator {
-    mutable IB beginIterator;
-    mutable IE endIterator;
-    IB &&begin() const { return std::move(beginIterator); }
-    IE &&end() const { return std::move(endIterator); }
-    WrappedIterator(IB &&begin, IE &&end)
+  struct MultiPassIterable {};
+
+  namespace iterator_detail {
+    template <class I, class = void> struct IsForwardIterator : std::false_type {};
+
+    template <class I>
+    struct IsForwardIterator<I, std::void_t<typename std::iterator_traits<I>::iterator_category>>
+        : std::is_base_of<std::forward_iterator_tag,
+                          typename std::iterator_traits<I>::iterator_category> {};
+
+    template <class T, class = void> struct DeclaresMultiPass
+        : std::is_base_of<MultiPassIterable, T> {};
+
+    template <class T> struct DeclaresMultiPass<T, std::void_t<decltype(T::multiPass)>>
+        : std::bool_constant<T::multiPass> {};
+
+    /**
+     * True if copies of `I` can be advanced independently, so that an iterable can be traversed
+     * repeatedly by copying its begin iterator. Holds for forward iterators, plain values and
+     * states derived from `MultiPassIterable` or declaring `static constexpr bool multiPass`,
+     * which adaptors derive from their source. Anything else is assumed to be single-pass.
+     */
+    template <class I> struct IsMultiPass
+        : std::bool_constant<std::is_copy_constructible<I>::value
+                             && (IsForwardIterator<I>::value || std::is_arithmetic<I>::value
+                                 || DeclaresMultiPass<I>::value)> {};
+
+    template <class... T> struct IsMultiPass<std::tuple<T...>>
+        : std::conjunction<IsMultiPass<T>...> {};
+
+    template <class T, class F, class D, class C> struct IsMultiPass<Iterator<T, F, D, C>>
+        : std::bool_constant<std::is_copy_constructible<Iterator<T, F, D, C>>::value
+                             && IsMultiPass<T>::value> {};
+
+    template <class T> struct IsMultiPass<RangeIterator<T>> : std::is_copy_constructible<T> {};
+
+    template <class T> struct IsMultiPass<GeneratorIterator<T>> : IsMultiPass<T> {};
+
+    template <class I> static constexpr bool isMultiPass = IsMultiPass<I>::value;
+  }  // namespace iterator_detail
+
+  /**
+   * Helper class for `wrap()`. Each call to `begin()` returns a copy of the stored iterator if
+   * it is multi-pass, otherwise the iterator is moved out and the object can only be traversed
+   * once.
+   */
+  template <class IB, class IE = IB> struct WrappedIterator
+      : iterator_detail::UseTracker<!iterator_detail::isMultiPass<IB>> {
+    static constexpr bool multiPass = iterator_detail::isMultiPass<IB>;
+
+    IB beginIterator;
+    IE endIterator;
+    constexpr decltype(auto) begin() {
+      if constexpr (multiPass) {
+        return IB(std::as_const(beginIterator));
+      } else {
+        this->markUsed();
+        return std::move(beginIterator);
+      }
+    }
+    constexpr decltype(auto) end() {
+      if constexpr (std::is_copy_constructible<IE>::value) {
+        return IE(std::as_const(endIterator));
+      } else {
+        return std::move(endIterator);
+      }
+    }
+    // const access iterates over copies of the stored iterators
+    constexpr IB begin() const { return beginIterator; }
+    constexpr IE end() const { return endIterator; }
+    constexpr WrappedIterator(IB &&begin, IE &&end)
         : beginIterator(std::move(begin)), endIterator(std::move(end)) {}
   };
 
   /**
-   * Wraps two iterators into a single-use container with begin/end methods to match the C++
-   * iterator convention.
+   * Wraps two iterators into a container with begin/end methods to match the C++ iterator
+   * convention. The result can be traversed repeatedly if the iterators are multi-pass.
    */
-  template <class IB, class IE> auto wrap(IB &&a, IE &&b) {
+  template <class IB, class IE> constexpr auto wrap(IB &&a, IE &&b) {
     return WrappedIterator<IB, IE>(std::forward<IB>(a), std::forward<IE>(b));
   }
 
@@ -310,22 +582,32 @@ namespace easy_iterator {
   template <class T> struct RangeIterator : public IteratorPrototype<T, dereference::ByValue> {
     T increment;
 
-    RangeIterator(const T &start, const T &_increment = 1)
+    constexpr RangeIterator(const T &start, const T &_increment = 1)
         : IteratorPrototype<T, dereference::ByValue>(start), increment(_increment) {}
 
-    RangeIterator &operator++() {
+    constexpr RangeIterator &operator++() {
       RangeIterator::value += increment;
       return *this;
     }
+
+    /**
+     * The number of steps needed to advance from `begin` to `end`.
+     */
+    friend constexpr std::ptrdiff_t operator-(const RangeIterator &end,
+                                             const RangeIterator &begin) {
+      return std::ptrdiff_t((end.value - begin.value) / begin.increment);
+    }
   };
 
-  template <class T> RangeIterator<T> rangeValue(T v, T i = 1) { return RangeIterator<T>(v, i); }
+  template <class T> constexpr RangeIterator<T> rangeValue(T v, T i = 1) {
+    return RangeIterator<T>(v, i);
+  }
 
   /**
    * Returns an iterator that increases it's value from `begin` to the first value <= `end` by
    * `increment` for each step.
    */
-  template <class T> auto range(T begin, T end, T increment) {
+  template <class T> constexpr auto range(T begin, T end, T increment) {
     auto actualEnd = end - ((end - begin) % increment);
     return wrap(rangeValue(begin, increment), rangeValue(actualEnd, increment));
   }
@@ -333,23 +615,25 @@ namespace easy_iterator {
   /**
    * Returns an iterator that increases its value from `begin` to `end` by `1` for each step.
    */
-  template <class T> auto range(T begin, T end) { return range<T>(begin, end, 1); }
+  template <class T> constexpr auto range(T begin, T end) { return range<T>(begin, end, 1); }
 
   /**
    * Returns an iterator that increases its value from `0` to `end` by `1` for each step.
    */
-  template <class T> auto range(T end) { return range<T>(0, end); }
+  template <class T> constexpr auto range(T end) { return range<T>(0, end); }
 
   /**
    * Wraps the `rbegin` and `rend` iterators.
    */
-  template <class T> auto reverse(T &v) { return wrap(v.rbegin(), v.rend()); }
+  template <class T> constexpr auto reverse(T &v) { return wrap(v.rbegin(), v.rend()); }
 
   /**
    * Returns an iterable object where all argument iterators are traversed simultaneously.
-   * Behaviour is undefined if the iterators do not have the same length.
+   * Behaviour is undefined if the iterators do not have the same length, which is checked when
+   * `EASY_ITERATOR_DEBUG` is enabled.
    */
-  template <typename... Args> auto zip(Args &&...args) {
+  template <typename... Args> constexpr auto zip(Args &&...args) {
+    iterator_detail::checkNoTemporaryContainers<Args...>();
     auto begin = Iterator(std::make_tuple(args.begin()...), increment::ByTupleIncrement(),
                           dereference::ByTupleDereference(), compare::ByLastTupleElementMatch());
     auto end = Iterator(std::make_tuple(args.end()...), increment::ByTupleIncrement(),
@@ -360,7 +644,8 @@ namespace easy_iterator {
   /**
    * Returns an object that is iterated as `[index, value]`.
    */
-  template <class T> auto enumerate(T &&t) {
+  template <class T> constexpr auto enumerate(T &&t) {
+    iterator_detail::checkNoTemporaryContainers<T>();
     return zip(wrap(RangeIterator<size_t>(0), IterationEnd()), t);
   }
 
@@ -372,32 +657,510 @@ namespace easy_iterator {
 
   /**
    * Take a class `T` with that defines the methods `T::advance()` and `O T::value()` for any type
-   * `O` and wraps it into a single-use iterable class. The return value of `T::advance()` is used
-   * to indicate the state of the iterator.
+   * `O` and wraps it into an iterable class. The return value of `T::advance()` is used to
+   * indicate the state of the iterator. If `T` is copyable and derived from `MultiPassIterable`,
+   * every traversal starts from a copy of the initial state. Otherwise the state is moved out and
+   * the iterable can only be traversed once.
    */
-  template <class T> struct MakeIterable {
-    mutable Iterator<T, increment::ByMemberCall<T, decltype(&T::advance), &T::advance>,
-                     dereference::ByMemberCall<T, decltype(&T::value), &T::value>, compare::ByValue>
-        start;
+  template <class T> struct MakeIterable
+      : iterator_detail::UseTracker<!iterator_detail::isMultiPass<T>> {
+    static constexpr bool multiPass = iterator_detail::isMultiPass<T>;
+
+    using IteratorType
+        = Iterator<T, increment::ByMemberCall<T, decltype(&T::advance), &T::advance>,
+                   dereference::ByMemberCall<T, decltype(&T::value), &T::value>, compare::ByValue>;
 
-    auto &&begin() const {
+    IteratorType start;
+
+    constexpr decltype(auto) begin() {
+      if constexpr (multiPass) {
+        return std::as_const(*this).begin();
+      } else {
+        this->markUsed();
+        if constexpr (std::is_base_of<InitializedIterable, T>::value) {
+          start.state = start.value.init();
+        }
+        return std::move(start);
+      }
+    }
+    // const access iterates over a copy of the initial state
+    constexpr IteratorType begin() const {
+      auto copy = start;
       if constexpr (std::is_base_of<InitializedIterable, T>::value) {
-        start.state = start.value.init();
+        copy.state = copy.value.init();
       }
-      return std::move(start);
+      return copy;
     }
-    auto end() const { return IterationEnd(); }
+    constexpr auto end() const { return IterationEnd(); }
+
+    constexpr explicit MakeIterable(T &&value) : start(std::move(value)) {}
+    template <typename... Args> constexpr explicit MakeIterable(Args &&...args)
+        : start(T(std::forward<Args>(args)...)) {}
+  };
+
+  namespace iterator_detail {
+    template <class T, class = void> struct HasSizeHint : std::false_type {};
+
+    template <class T>
+    struct HasSizeHint<T, std::void_t<decltype(std::declval<const T &>().sizeHint())>>
+        : std::true_type {};
+  }  // namespace iterator_detail
+
+  /**
+   * Iterator for `MakeGenerator`. Only `operator!=` checks for the end of the sequence, so
+   * incrementing or dereferencing an exhausted generator is undefined behaviour.
+   */
+  template <class T> class GeneratorIterator {
+  private:
+    using AdvanceResult = decltype(std::declval<T &>().advance());
+
+    T generator;
+    bool active = true;
+
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using reference = decltype(std::declval<T &>().value());
+    using value_type = std::decay_t<reference>;
+    using pointer = void;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr explicit GeneratorIterator(T &&_generator) : generator(std::move(_generator)) {}
+
+    /**
+     * Calls `T::init()` for generators derived from `InitializedIterable`.
+     */
+    constexpr void initialize() {
+      if constexpr (std::is_base_of<InitializedIterable, T>::value) {
+        active = generator.init();
+      }
+    }
+
+    constexpr reference operator*() noexcept(noexcept(std::declval<T &>().value())) {
+      return generator.value();
+    }
+
+    constexpr GeneratorIterator &operator++() {
+      if constexpr (std::is_same<AdvanceResult, void>::value) {
+        generator.advance();
+      } else {
+        active = generator.advance();
+      }
+      return *this;
+    }
+
+    /**
+     * The number of remaining elements as reported by `T::sizeHint()`, if defined.
+     */
+    template <class G = T, typename = std::enable_if_t<iterator_detail::HasSizeHint<G>::value>>
+    constexpr std::ptrdiff_t sizeHint() const {
+      return active ? std::ptrdiff_t(generator.sizeHint()) : 0;
+    }
+
+    constexpr explicit operator bool() const { return active; }
+
+    constexpr bool operator!=(const IterationEnd &) const { return active; }
+    constexpr bool operator==(const IterationEnd &) const { return !active; }
+  };
 
-    explicit MakeIterable(T &&value) : start(std::move(value)) {}
-    template <typename... Args> explicit MakeIterable(Args &&...args)
+  /**
+   * Alternative to `MakeIterable` for hot loops. Takes a class `T` with the same interface,
+   * but the returned state of `T::advance()` is only checked once per step when comparing
+   * against the end, and dereferencing never throws. Generators may additionally define
+   * `size_t T::sizeHint() const`, returning the number of remaining values, which is used to
+   * pre-size containers in `collect()`. As for `MakeIterable`, generators are traversed once
+   * unless they derive from `MultiPassIterable`.
+   */
+  template <class T> struct MakeGenerator
+      : iterator_detail::UseTracker<!iterator_detail::isMultiPass<T>> {
+    static constexpr bool multiPass = iterator_detail::isMultiPass<T>;
+
+    GeneratorIterator<T> start;
+
+    constexpr decltype(auto) begin() {
+      if constexpr (multiPass) {
+        return std::as_const(*this).begin();
+      } else {
+        this->markUsed();
+        start.initialize();
+        return std::move(start);
+      }
+    }
+    // const access iterates over a copy of the initial state
+    constexpr GeneratorIterator<T> begin() const {
+      auto copy = start;
+      copy.initialize();
+      return copy;
+    }
+    constexpr auto end() const { return IterationEnd(); }
+
+    constexpr explicit MakeGenerator(T &&value) : start(std::move(value)) {}
+    template <typename... Args> constexpr explicit MakeGenerator(Args &&...args)
         : start(T(std::forward<Args>(args)...)) {}
   };
 
   /**
    * Iterates over the dereferenced values between `begin` and `end`.
    */
-  template <class T, class I = increment::ByValue<1>> auto valuesBetween(T *begin, T *end) {
-    return wrap(ReferenceIterator<T, I>(begin), Iterator(end));
+  template <class T, class I = increment::ByValue<1>>
+  constexpr auto valuesBetween(T *begin, T *end) {
+    if constexpr (iterator_detail::debug) {
+      using Dereference = iterator_detail::BoundsCheckedDereference<T>;
+      return wrap(Iterator<T *, I, Dereference>(begin, I(), Dereference{begin, end}),
+                  Iterator(end));
+    } else {
+      return wrap(ReferenceIterator<T, I>(begin), Iterator(end));
+    }
+  }
+
+  namespace any_detail {
+    /**
+     * The number of bytes of iterator state stored inline by `AnyIterable`.
+     */
+    constexpr size_t inlineSize = 8 * sizeof(void *);
+
+    template <class B, class E> struct Range {
+      B current;
+      E end;
+    };
+
+    /**
+     * A type-erased pair of iterators with a manual virtual table. States of up to `inlineSize`
+     * bytes are stored without heap allocation.
+     */
+    template <class T> class Cursor {
+    private:
+      struct VTable {
+        size_t (*fill)(Cursor &, T *, size_t);
+        void (*copy)(const Cursor &, Cursor &);
+        void (*move)(Cursor &, Cursor &);
+        void (*destroy)(Cursor &);
+      };
+
+      alignas(std::max_align_t) unsigned char storage[inlineSize];
+      const VTable *vtable = nullptr;
+
+      template <class R> static constexpr bool isInline
+          = sizeof(R) <= inlineSize && alignof(R) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<R>::value;
+
+      template <class R> R &get() {
+        if constexpr (isInline<R>) {
+          return *std::launder(reinterpret_cast<R *>(storage));
+        } else {
+          return **std::launder(reinterpret_cast<R **>(storage));
+        }
+      }
+
+      template <class R> const R &get() const { return const_cast<Cursor *>(this)->get<R>(); }
+
+      template <class R> void emplace(R &&range) {
+        if constexpr (isInline<R>) {
+          new (storage) R(std::move(range));
+        } else {
+          new (storage) R *(new R(std::move(range)));
+        }
+      }
+
+      template <class R> static size_t fill(Cursor &cursor, T *buffer, size_t capacity) {
+        auto &range = cursor.get<R>();
+        size_t count = 0;
+        while (count < capacity && range.current != range.end) {
+          buffer[count++] = *range.current;
+          ++range.current;
+        }
+        return count;
+      }
+
+      template <class R> static void copy(const Cursor &from, Cursor &to) {
+        R range = from.get<R>();
+        to.emplace(std::move(range));
+      }
+
+      template <class R> static void move(Cursor &from, Cursor &to) {
+        if constexpr (isInline<R>) {
+          to.emplace(std::move(from.get<R>()));
+        } else {
+          new (to.storage) R *(&from.get<R>());
+          from.vtable = nullptr;
+        }
+      }
+
+      template <class R> static void destroy(Cursor &cursor) {
+        if constexpr (isInline<R>) {
+          cursor.get<R>().~R();
+        } else {
+          delete &cursor.get<R>();
+        }
+      }
+
+      template <class R> static constexpr VTable vtableFor{&fill<R>, &copy<R>, &move<R>,
+                                                           &destroy<R>};
+
+      void reset() {
+        if (vtable) {
+          vtable->destroy(*this);
+          vtable = nullptr;
+        }
+      }
+
+    public:
+      template <class B, class E> Cursor(B begin, E end) {
+        using R = Range<B, E>;
+        emplace(R{std::move(begin), std::move(end)});
+        vtable = &vtableFor<R>;
+      }
+
+      Cursor(const Cursor &other) : vtable(other.vtable) {
+        if (vtable) {
+          vtable->copy(other, *this);
+        }
+      }
+
+      Cursor(Cursor &&other) noexcept : vtable(other.vtable) {
+        if (vtable) {
+          vtable->move(other, *this);
+        }
+      }
+
+      Cursor &operator=(const Cursor &other) { return *this = Cursor(other); }
+
+      Cursor &operator=(Cursor &&other) noexcept {
+        if (this != &other) {
+          reset();
+          if (other.vtable) {
+            vtable = other.vtable;
+            vtable->move(other, *this);
+          }
+        }
+        return *this;
+      }
+
+      ~Cursor() { reset(); }
+
+      /**
+       * Copies up to `capacity` elements into `buffer` and returns their number.
+       */
+      size_t fill(T *buffer, size_t capacity) { return vtable->fill(*this, buffer, capacity); }
+    };
+  }  // namespace any_detail
+
+  /**
+   * A type-erased iterable yielding values of type `T`, which can hold any iterable whose
+   * elements convert to `T`. Iterator states of up to `any_detail::inlineSize` bytes are stored
+   * without heap allocation. Elements are copied in batches of `BatchSize` into a buffer held by
+   * the iterator, so that the indirect call is made once per batch rather than per element.
+   * Requires default constructible and copy assignable values. Like `zip`, the iterable refers
+   * to the containers it was created from, which must outlive it.
+   */
+  template <class T, size_t BatchSize = 64> class AnyIterable {
+  private:
+    static_assert(BatchSize > 0, "batches must hold at least one element");
+
+    any_detail::Cursor<T> start;
+
+  public:
+    class iterator {
+    private:
+      any_detail::Cursor<T> cursor;
+      std::array<T, BatchSize> buffer;
+      size_t position = 0, count = 0;
+
+      void refill() {
+        position = 0;
+        count = cursor.fill(buffer.data(), BatchSize);
+      }
+
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using reference = const T &;
+      using value_type = T;
+      using pointer = const T *;
+      using difference_type = std::ptrdiff_t;
+
+      explicit iterator(const any_detail::Cursor<T> &_cursor) : cursor(_cursor) { refill(); }
+
+      reference operator*() const { return buffer[position]; }
+      pointer operator->() const { return &buffer[position]; }
+
+      iterator &operator++() {
+        if (++position == count && count == BatchSize) {
+          refill();
+        }
+        return *this;
+      }
+
+      bool operator!=(const IterationEnd &) const { return position != count; }
+      bool operator==(const IterationEnd &) const { return position == count; }
+    };
+
+    template <class I,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<I>, AnyIterable>::value>,
+              class = iterator_detail::NoTemporaryContainers<I>>
+    AnyIterable(I &&iterable) : start(std::begin(iterable), std::end(iterable)) {
+    }
+
+    iterator begin() const { return iterator(start); }
+    IterationEnd end() const { return IterationEnd(); }
+
+    /**
+     * Calls `f(const T *data, size_t count)` for consecutive batches of elements, avoiding the
+     * per-element overhead of iterating.
+     */
+    template <class F> void forEachBatch(F &&f) const {
+      any_detail::Cursor<T> cursor = start;
+      std::array<T, BatchSize> buffer;
+      size_t count;
+      do {
+        count = cursor.fill(buffer.data(), BatchSize);
+        if (count > 0) {
+          f(static_cast<const T *>(buffer.data()), count);
+        }
+      } while (count == BatchSize);
+    }
+  };
+
+  /**
+   * A flag shared between all of its copies, used to request cancellation of iterations running
+   * with `withBudget()`, possibly on other threads.
+   */
+  class CancellationToken {
+  private:
+    std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+
+  public:
+    void cancel() const { flag->store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag->load(std::memory_order_relaxed); }
+  };
+
+  namespace budget_detail {
+    struct TokenLimit {
+      CancellationToken token;
+      bool expired() const { return token.cancelled(); }
+    };
+
+    struct DeadlineLimit {
+      std::chrono::steady_clock::time_point deadline;
+      bool expired() const { return std::chrono::steady_clock::now() >= deadline; }
+    };
+
+    inline TokenLimit makeLimit(const CancellationToken &token) { return TokenLimit{token}; }
+    inline TokenLimit makeLimit(const TokenLimit &limit) { return limit; }
+    inline DeadlineLimit makeLimit(const DeadlineLimit &limit) { return limit; }
+
+    template <class Duration>
+    DeadlineLimit makeLimit(const std::chrono::time_point<std::chrono::steady_clock, Duration> &t) {
+      return DeadlineLimit{t};
+    }
+
+    template <class Rep, class Period>
+    DeadlineLimit makeLimit(const std::chrono::duration<Rep, Period> &budget) {
+      using Clock = std::chrono::steady_clock;
+      return DeadlineLimit{Clock::now() + std::chrono::duration_cast<Clock::duration>(budget)};
+    }
+
+    /**
+     * Yields the elements of `[current, end)` until `limit` expires, checking it once every
+     * `interval` elements.
+     */
+    template <class I, class E, class L> struct Budgeted : InitializedIterable {
+      static constexpr bool multiPass = iterator_detail::isMultiPass<I>;
+
+      I current;
+      E end;
+      L limit;
+      size_t interval, countdown;
+
+      Budgeted(I begin, E _end, L _limit, size_t _interval)
+          : current(std::move(begin)),
+            end(std::move(_end)),
+            limit(std::move(_limit)),
+            interval(std::max(_interval, size_t(1))),
+            countdown(interval) {}
+
+      bool init() { return current != end && !limit.expired(); }
+      bool advance() {
+        ++current;
+        if (--countdown == 0) {
+          countdown = interval;
+          if (limit.expired()) {
+            return false;
+          }
+        }
+        return current != end;
+      }
+      decltype(auto) value() noexcept(noexcept(*current)) { return *current; }
+    };
+  }  // namespace budget_detail
+
+  /**
+   * Execution policies for the bulk algorithms, mirroring those of the standard library.
+   * Unsequenced policies are currently executed like their sequenced counterparts.
+   */
+  namespace execution {
+    struct SequencedPolicy {};
+    struct UnsequencedPolicy {};
+    struct ParallelPolicy {};
+    struct ParallelUnsequencedPolicy {};
+
+    constexpr SequencedPolicy seq{};
+    constexpr UnsequencedPolicy unseq{};
+    constexpr ParallelPolicy par{};
+    constexpr ParallelUnsequencedPolicy par_unseq{};
+
+    /**
+     * Executes like `P`, but stops processing further elements once `limit` expires. The limit is
+     * checked before every block of `interval` elements. Created by `withBudget()`.
+     */
+    template <class P, class L> struct BudgetedPolicy {
+      P policy;
+      L limit;
+      size_t interval;
+    };
+
+    template <class P> struct IsParallel
+        : std::bool_constant<std::is_same<P, ParallelPolicy>::value
+                             || std::is_same<P, ParallelUnsequencedPolicy>::value> {};
+
+    template <class P, class L> struct IsParallel<BudgetedPolicy<P, L>> : IsParallel<P> {};
+
+    template <class P> struct IsExecutionPolicy
+        : std::bool_constant<IsParallel<P>::value || std::is_same<P, SequencedPolicy>::value
+                             || std::is_same<P, UnsequencedPolicy>::value> {};
+
+    template <class P, class L> struct IsExecutionPolicy<BudgetedPolicy<P, L>>
+        : IsExecutionPolicy<P> {};
+
+    template <class P> static constexpr bool isParallel = IsParallel<std::decay_t<P>>::value;
+
+    template <class P> static constexpr bool isExecutionPolicy
+        = IsExecutionPolicy<std::decay_t<P>>::value;
+
+    template <class P> struct IsBudgeted : std::false_type {};
+
+    template <class P, class L> struct IsBudgeted<BudgetedPolicy<P, L>> : std::true_type {};
+
+    template <class P> static constexpr bool isBudgeted = IsBudgeted<std::decay_t<P>>::value;
+  }  // namespace execution
+
+  /**
+   * Limits an iteration by a `CancellationToken`, a `std::chrono::steady_clock` deadline or a
+   * duration starting now. Applied to an iterable, returns an iterable that ends early once the
+   * limit expires. Applied to an execution policy, returns a policy under which the bulk
+   * algorithms stop processing further elements. The limit is only checked once every
+   * `checkInterval` elements, so that checking a deadline does not read the clock per element.
+   */
+  template <class T, class L, class = iterator_detail::NoTemporaryContainers<T>>
+  auto withBudget(T &&target, const L &limit, size_t checkInterval = 1024) {
+    auto budget = budget_detail::makeLimit(limit);
+    if constexpr (execution::isExecutionPolicy<T>) {
+      return execution::BudgetedPolicy<std::decay_t<T>, decltype(budget)>{target, budget,
+                                                                           checkInterval};
+    } else {
+      using Budgeted = budget_detail::Budgeted<iterator_detail::BeginType<T>,
+                                               iterator_detail::EndType<T>, decltype(budget)>;
+      return MakeGenerator<Budgeted>(
+          Budgeted(std::begin(target), std::end(target), budget, checkInterval));
+    }
   }
 
   /**
@@ -416,17 +1179,320 @@ namespace easy_iterator {
    * @param `f` (optional) - a function to transform values before copying.
    * Behaviour is undefined if `a` and `b` do not have the same size.
    */
-  template <class A, class B, class T = dereference::ByValueReference>
+  template <class A, class B, class T = dereference::ByValueReference,
+            typename = std::enable_if_t<!execution::isExecutionPolicy<A>>>
   void copy(const A &a, B &b, T &&t = T()) {
     for (auto [v1, v2] : zip(a, b)) {
       v2 = t(v1);
     }
   }
 
-  /**
-   * Returns a pointer to the value if found, otherwise `nullptr`.
-   * Usage: `if(auto v = found(map.find(key), map)) { do_something(v); }`
-   */
+  namespace parallel_detail {
+    /**
+     * Fixed-size thread pool used by the parallel algorithms. Work is statically partitioned:
+     * chunk `0` always runs on the calling thread and chunk `i` on worker `i - 1`, so repeated
+     * passes over the same data touch the same memory from the same thread.
+     */
+    class ThreadPool {
+    private:
+      std::vector<std::thread> workers;
+      std::mutex mutex, runMutex;
+      std::condition_variable wake, finished;
+      const std::function<void(size_t)> *task = nullptr;
+      std::exception_ptr error;
+      size_t generation = 0, chunks = 0, pending = 0;
+      bool stopping = false;
+
+      static bool &insidePool() {
+        thread_local bool value = false;
+        return value;
+      }
+
+      void work(size_t chunk) {
+        insidePool() = true;
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+          wake.wait(lock, [&]() { return stopping || generation != seen; });
+          if (stopping) {
+            return;
+          }
+          seen = generation;
+          if (chunk < chunks) {
+            auto current = task;
+            lock.unlock();
+            try {
+              (*current)(chunk);
+            } catch (...) {
+              std::lock_guard<std::mutex> errorLock(mutex);
+              if (!error) {
+                error = std::current_exception();
+              }
+            }
+            lock.lock();
+            if (--pending == 0) {
+              finished.notify_one();
+            }
+          }
+        }
+      }
+
+    public:
+      explicit ThreadPool(size_t threads) {
+        for (size_t i = 1; i < threads; ++i) {
+          workers.emplace_back([this, i]() { work(i); });
+        }
+      }
+
+      ThreadPool(const ThreadPool &) = delete;
+
+      ~ThreadPool() {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker : workers) {
+          worker.join();
+        }
+      }
+
+      /**
+       * The number of threads available, including the calling thread.
+       */
+      size_t size() const { return workers.size() + 1; }
+
+      /**
+       * Calls `f(i)` for every `i` in `[0, n)` in parallel and blocks until all calls returned.
+       * `n` must not exceed `size()`. Nested calls from inside a task are executed serially.
+       */
+      void run(size_t n, const std::function<void(size_t)> &f) {
+        if (n <= 1 || insidePool()) {
+          for (size_t i = 0; i < n; ++i) {
+            f(i);
+          }
+          return;
+        }
+        std::lock_guard<std::mutex> runLock(runMutex);
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          task = &f;
+          chunks = n;
+          pending = n - 1;
+          error = nullptr;
+          ++generation;
+        }
+        wake.notify_all();
+        std::exception_ptr localError;
+        insidePool() = true;
+        try {
+          f(0);
+        } catch (...) {
+          localError = std::current_exception();
+        }
+        insidePool() = false;
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]() { return pending == 0; });
+        if (!localError) {
+          localError = error;
+        }
+        if (localError) {
+          std::rethrow_exception(localError);
+        }
+      }
+
+      /**
+       * The shared pool, created with one thread per hardware thread on first use.
+       */
+      static ThreadPool &global() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+      }
+    };
+
+    /**
+     * Inputs smaller than this number of elements per thread are processed serially.
+     */
+    constexpr size_t minimumChunkSize = 1 << 14;
+
+    /**
+     * Splits `[0, size)` into contiguous chunks and calls `f(begin, end)` for each chunk on the
+     * thread pool. Falls back to a single serial call for small inputs.
+     */
+    template <class F> void parallelFor(size_t size, F &&f) {
+      auto &pool = ThreadPool::global();
+      auto chunks = std::min(pool.size(), (size + minimumChunkSize - 1) / minimumChunkSize);
+      if (chunks <= 1) {
+        f(size_t(0), size);
+        return;
+      }
+      std::function<void(size_t)> task
+          = [&](size_t i) { f(size * i / chunks, size * (i + 1) / chunks); };
+      pool.run(chunks, task);
+    }
+
+    template <class T, class = void> struct IsRandomAccess : std::false_type {};
+
+    template <class T> struct IsRandomAccess<
+        T, std::void_t<typename std::iterator_traits<
+               std::decay_t<decltype(std::begin(std::declval<T &>()))>>::iterator_category>>
+        : std::is_base_of<std::random_access_iterator_tag,
+                          typename std::iterator_traits<std::decay_t<decltype(
+                              std::begin(std::declval<T &>()))>>::iterator_category> {};
+
+    template <class T> static constexpr bool isRandomAccess = IsRandomAccess<T>::value;
+
+    template <class... Args> static constexpr bool allRandomAccess
+        = (isRandomAccess<std::remove_reference_t<Args>> && ...);
+
+    /**
+     * Calls `f(begin, end)` on index chunks of `size` elements according to `policy`. Chunks of
+     * budgeted policies are further split into blocks, which are skipped once the limit expires.
+     * Returns false if any block was skipped.
+     */
+    template <class P, class F> bool forChunks(const P &policy, size_t size, F &&f) {
+      if constexpr (execution::isBudgeted<P>) {
+        auto interval = std::max(policy.interval, size_t(1));
+        std::atomic<bool> complete(true);
+        forChunks(policy.policy, size, [&](size_t begin, size_t end) {
+          for (auto block = begin; block < end; block += interval) {
+            if (policy.limit.expired()) {
+              complete.store(false, std::memory_order_relaxed);
+              return;
+            }
+            f(block, std::min(block + interval, end));
+          }
+        });
+        return complete.load(std::memory_order_relaxed);
+      } else if constexpr (execution::isParallel<P>) {
+        parallelFor(size, std::forward<F>(f));
+      } else {
+        f(size_t(0), size);
+      }
+      return true;
+    }
+
+    /**
+     * Serially calls `f(value)` for the elements of `iterable`, checking the limit of budgeted
+     * policies before every block of elements. Returns false if elements were skipped.
+     */
+    template <class P, class T, class F> bool forValues(const P &policy, T &&iterable, F &&f) {
+      auto it = std::begin(iterable);
+      auto end = std::end(iterable);
+      if constexpr (execution::isBudgeted<P>) {
+        auto interval = std::max(policy.interval, size_t(1));
+        while (it != end) {
+          if (policy.limit.expired()) {
+            return false;
+          }
+          for (size_t i = 0; i < interval && it != end; ++i, ++it) {
+            f(*it);
+          }
+        }
+      } else {
+        for (; it != end; ++it) {
+          f(*it);
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Serially iterates over `iterable`, honouring the limit of budgeted policies.
+     */
+    template <class P, class T> decltype(auto) serial(const P &policy, T &&iterable) {
+      if constexpr (execution::isBudgeted<P>) {
+        return withBudget(std::forward<T>(iterable), policy.limit, policy.interval);
+      } else {
+        return std::forward<T>(iterable);
+      }
+    }
+
+    /**
+     * The sequenced policy with the same limit as `policy`.
+     */
+    template <class P> auto sequenced(const P &policy) {
+      if constexpr (execution::isBudgeted<P>) {
+        return execution::BudgetedPolicy<execution::SequencedPolicy, decltype(policy.limit)>{
+            execution::seq, policy.limit, policy.interval};
+      } else {
+        return execution::seq;
+      }
+    }
+  }  // namespace parallel_detail
+
+  /**
+   * Copy-assigns the given value to every element in a container using the execution policy
+   * `policy`. Containers without random access iterators are filled serially.
+   * Returns false if the limit of a budgeted policy expired before every element was assigned.
+   * In parallel, the unassigned elements may be scattered over the container.
+   */
+  template <class P, class T, class A,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  bool fill(P &&policy, A &arr, const T &value) {
+    if constexpr (parallel_detail::isRandomAccess<A>) {
+      auto first = std::begin(arr);
+      return parallel_detail::forChunks(policy, std::size(arr), [&](size_t begin, size_t end) {
+        for (auto it = first + begin, last = first + end; it != last; ++it) {
+          *it = value;
+        }
+      });
+    } else {
+      return parallel_detail::forValues(policy, arr, [&](auto &v) { v = value; });
+    }
+  }
+
+  /**
+   * Calls `f` with the elements of all containers in lockstep, equivalent to iterating over
+   * `zip(containers...)`, using the execution policy `policy`. Falls back to serial iteration
+   * unless all containers provide random access iterators.
+   * Returns false if the limit of a budgeted policy expired before `f` was called for every
+   * element. In parallel, the skipped elements may be scattered over the containers.
+   * Behaviour is undefined if the containers do not have the same size.
+   */
+  template <class P, class F, class... Args,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  bool forEach(P &&policy, F &&f, Args &&...args) {
+    if constexpr (parallel_detail::allRandomAccess<Args...>) {
+      auto size = std::size(std::get<sizeof...(Args) - 1>(std::forward_as_tuple(args...)));
+      auto first = std::make_tuple(std::begin(args)...);
+      return parallel_detail::forChunks(policy, size, [&](size_t begin, size_t end) {
+        // seek once per chunk, as jumps may be more expensive than steps
+        std::apply(
+            [&](auto... its) {
+              ((its += std::ptrdiff_t(begin)), ...);
+              for (auto i = begin; i < end; ++i, (++its, ...)) {
+                f(*its...);
+              }
+            },
+            first);
+      });
+    } else {
+      auto zipped = zip(args...);
+      return parallel_detail::forValues(policy, zipped,
+                                        [&](auto values) { std::apply(f, values); });
+    }
+  }
+
+  /**
+   * Copies values from one container to another using the execution policy `policy`.
+   * @param `a` - the container with values to be copies.
+   * @param `b` - the target container.
+   * @param `f` (optional) - a function to transform values before copying.
+   * Returns false if the limit of a budgeted policy expired before every value was copied.
+   * Behaviour is undefined if `a` and `b` do not have the same size.
+   */
+  template <class P, class A, class B, class T = dereference::ByValueReference,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  bool copy(P &&policy, const A &a, B &b, T &&t = T()) {
+    return forEach(
+        policy, [&](const auto &v1, auto &v2) { v2 = t(v1); }, a, b);
+  }
+
+  /**
+   * Returns a pointer to the value if found, otherwise `nullptr`.
+   * Usage: `if(auto v = found(map.find(key), map)) { do_something(v); }`
+   */
   template <class I, class C> decltype(&*std::declval<I>()) found(const I &it, C &container) {
     if (it != container.end()) {
       return &*it;
@@ -457,4 +1523,3361 @@ namespace easy_iterator {
     return found(it, c);
   }
 
+  namespace iterator_detail {
+    /**
+     * The remaining part of an iterable input.
+     */
+    template <class T> struct Source {
+      static constexpr bool multiPass = isMultiPass<BeginType<T>>;
+
+      BeginType<T> current;
+      EndType<T> end;
+      explicit Source(T &t) : current(std::begin(t)), end(std::end(t)) {}
+      bool done() const { return current == end; }
+    };
+
+    template <class I, class Tag, class = void> struct HasCategory : std::false_type {};
+
+    template <class I, class Tag>
+    struct HasCategory<I, Tag, std::void_t<typename std::iterator_traits<I>::iterator_category>>
+        : std::is_base_of<Tag, typename std::iterator_traits<I>::iterator_category> {};
+
+    /**
+     * True if the iterator type `I` declares an iterator category derived from `Tag`.
+     */
+    template <class I, class Tag> static constexpr bool hasCategory = HasCategory<I, Tag>::value;
+
+    template <class T, class = void> struct IsContiguous : std::false_type {};
+
+    template <class T> struct IsContiguous<T, std::void_t<decltype(std::data(std::declval<T &>())),
+                                                          decltype(std::size(std::declval<T &>()))>>
+        : std::true_type {};
+
+    /**
+     * True for containers exposing their elements as a contiguous array through `data()`.
+     */
+    template <class T> static constexpr bool isContiguous = IsContiguous<T>::value;
+  }  // namespace iterator_detail
+
+  namespace sorted_detail {
+    using iterator_detail::BeginType;
+    using iterator_detail::EndType;
+    using iterator_detail::Source;
+
+    template <class T> static constexpr bool isRandomAccessSource = std::is_base_of<
+        std::random_access_iterator_tag,
+        typename std::iterator_traits<BeginType<T>>::iterator_category>::value;
+
+    /**
+     * Advances `source` to the first element not less than `target`. Random access inputs are
+     * advanced by galloping (exponential) search followed by a binary search, so that skipping
+     * `n` elements costs `O(log n)` comparisons.
+     */
+    template <class T, class V, class C> void seek(Source<T> &source, const V &target, C &compare) {
+      if constexpr (isRandomAccessSource<T> && std::is_same<BeginType<T>, EndType<T>>::value) {
+        auto remaining = source.end - source.current;
+        decltype(remaining) step = 1;
+        while (step < remaining && compare(source.current[step], target)) {
+          source.current += step;
+          remaining -= step;
+          step *= 2;
+        }
+        auto last = source.current + std::min(step, remaining);
+        source.current = std::lower_bound(source.current, last, target, compare);
+      } else {
+        while (!source.done() && compare(*source.current, target)) {
+          ++source.current;
+        }
+      }
+    }
+
+    /**
+     * Merges any number of sorted sources with a binary min-heap of source indices.
+     */
+    template <class T, class Sources, class Heap, class C> struct Merge : InitializedIterable {
+      static constexpr bool multiPass = iterator_detail::Source<T>::multiPass;
+
+      Sources sources;
+      Heap heap;
+      size_t heapSize = 0;
+      C compare;
+
+      Merge(Sources &&_sources, Heap &&_heap, C _compare)
+          : sources(std::move(_sources)), heap(std::move(_heap)), compare(_compare) {}
+
+      bool heapCompare(size_t a, size_t b) {
+        return compare(*sources[b].current, *sources[a].current);
+      }
+
+      bool init() {
+        auto heapOrder = [this](size_t a, size_t b) { return heapCompare(a, b); };
+        for (size_t i = 0; i < sources.size(); ++i) {
+          if (!sources[i].done()) {
+            heap[heapSize++] = i;
+          }
+        }
+        std::make_heap(heap.begin(), heap.begin() + heapSize, heapOrder);
+        return heapSize > 0;
+      }
+
+      bool advance() {
+        auto heapOrder = [this](size_t a, size_t b) { return heapCompare(a, b); };
+        std::pop_heap(heap.begin(), heap.begin() + heapSize, heapOrder);
+        auto &source = sources[heap[heapSize - 1]];
+        ++source.current;
+        if (source.done()) {
+          --heapSize;
+        } else {
+          std::push_heap(heap.begin(), heap.begin() + heapSize, heapOrder);
+        }
+        return heapSize > 0;
+      }
+
+      decltype(auto) value() { return *sources[heap[0]].current; }
+    };
+
+    /**
+     * Leapfrog intersection of sorted sources. Yields a tuple of the matching elements.
+     */
+    template <class C, class... Args> struct Intersection : InitializedIterable {
+      static constexpr bool multiPass = (Source<Args>::multiPass && ...);
+
+      std::tuple<Source<Args>...> sources;
+      C compare;
+
+      explicit Intersection(C _compare, Args &...args)
+          : sources(Source<Args>(args)...), compare(_compare) {}
+
+      bool anyDone() {
+        return std::apply([](auto &...s) { return (s.done() || ...); }, sources);
+      }
+
+      bool findMatch() {
+        while (!anyDone()) {
+          auto candidate = std::apply(
+              [this](auto &first, auto &...rest) {
+                std::common_type_t<std::decay_t<decltype(*first.current)>,
+                                   std::decay_t<decltype(*rest.current)>...>
+                    maximum = *first.current;
+                ((maximum = compare(maximum, *rest.current) ? *rest.current : maximum), ...);
+                return maximum;
+              },
+              sources);
+          bool matched = std::apply(
+              [&](auto &...s) {
+                (seek(s, candidate, compare), ...);
+                return ((!s.done() && !compare(candidate, *s.current)) && ...);
+              },
+              sources);
+          if (matched) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      bool init() { return findMatch(); }
+
+      bool advance() {
+        std::apply([](auto &...s) { (++s.current, ...); }, sources);
+        return findMatch();
+      }
+
+      auto value() {
+        return std::apply(
+            [](auto &...s) {
+              auto iterators = std::make_tuple(s.current...);
+              return dereference::ByTupleDereference()(iterators);
+            },
+            sources);
+      }
+    };
+
+    /**
+     * Yields the elements of sorted source `A` that have no matching element in sorted source `B`.
+     */
+    template <class C, class A, class B> struct Difference : InitializedIterable {
+      static constexpr bool multiPass = Source<A>::multiPass && Source<B>::multiPass;
+
+      Source<A> a;
+      Source<B> b;
+      C compare;
+
+      Difference(C _compare, A &_a, B &_b) : a(_a), b(_b), compare(_compare) {}
+
+      bool findUnmatched() {
+        while (!a.done()) {
+          seek(b, *a.current, compare);
+          if (b.done() || compare(*a.current, *b.current)) {
+            return true;
+          }
+          ++a.current;
+          ++b.current;
+        }
+        return false;
+      }
+
+      bool init() { return findUnmatched(); }
+
+      bool advance() {
+        ++a.current;
+        return findUnmatched();
+      }
+
+      decltype(auto) value() { return *a.current; }
+    };
+  }  // namespace sorted_detail
+
+  /**
+   * Lazily merges sorted iterables of the same type into a single sorted sequence. Elements are
+   * yielded by the underlying iterators' reference type.
+   * Behaviour is undefined if the inputs are not sorted by `operator<`.
+   */
+  template <class T, class... Args, class = iterator_detail::NoTemporaryContainers<T, Args...>>
+  auto merge(T &&first, Args &&...rest) {
+    using Iterable = std::remove_reference_t<T>;
+    static_assert((std::is_same<Iterable, std::remove_reference_t<Args>>::value && ...),
+                  "merge requires iterables of the same type, use mergeAll for other cases");
+    using Sources = std::array<iterator_detail::Source<Iterable>, sizeof...(Args) + 1>;
+    using Heap = std::array<size_t, sizeof...(Args) + 1>;
+    using Merge = sorted_detail::Merge<Iterable, Sources, Heap, std::less<>>;
+    return MakeIterable<Merge>(Merge(Sources{iterator_detail::Source<Iterable>(first),
+                                             iterator_detail::Source<Iterable>(rest)...},
+                                     Heap(), std::less<>()));
+  }
+
+  /**
+   * Lazily merges a container of sorted iterables, e.g. a `std::vector<std::vector<int>>`, into a
+   * single sorted sequence using a k-way heap merge.
+   * Behaviour is undefined if the inputs are not sorted by `operator<`.
+   */
+  template <class T> auto mergeAll(T &iterables) {
+    using Iterable = std::remove_reference_t<decltype(*std::begin(iterables))>;
+    using Sources = std::vector<iterator_detail::Source<Iterable>>;
+    using Merge = sorted_detail::Merge<Iterable, Sources, std::vector<size_t>, std::less<>>;
+    Sources sources;
+    for (auto &iterable : iterables) {
+      sources.emplace_back(iterable);
+    }
+    std::vector<size_t> heap(sources.size());
+    return MakeIterable<Merge>(Merge(std::move(sources), std::move(heap), std::less<>()));
+  }
+
+  /**
+   * Lazily intersects sorted iterables. Each match is yielded as a tuple with one element per
+   * input, similar to `zip`. Random access inputs are skipped through by galloping search, which
+   * makes intersecting inputs of very different size cheap.
+   * Behaviour is undefined if the inputs are not sorted by `operator<`.
+   */
+  template <typename... Args, class = iterator_detail::NoTemporaryContainers<Args...>>
+  auto intersect(Args &&...args) {
+    using Intersection
+        = sorted_detail::Intersection<std::less<>, std::remove_reference_t<Args>...>;
+    return MakeIterable<Intersection>(Intersection(std::less<>(), args...));
+  }
+
+  /**
+   * Lazily yields the elements of the sorted iterable `a` that are not contained in the sorted
+   * iterable `b`. Each element of `b` cancels at most one equal element of `a`.
+   * Behaviour is undefined if the inputs are not sorted by `operator<`.
+   */
+  template <class A, class B, class = iterator_detail::NoTemporaryContainers<A, B>>
+  auto difference(A &&a, B &&b) {
+    using Difference = sorted_detail::Difference<std::less<>, std::remove_reference_t<A>,
+                                                 std::remove_reference_t<B>>;
+    return MakeIterable<Difference>(Difference(std::less<>(), a, b));
+  }
+
+  namespace group_detail {
+    /**
+     * Returns the first position in `[begin, end)` not equal to `value`. Compares fixed-size
+     * blocks without early exit first, which allows the compiler to vectorize the scan.
+     */
+    template <class T> const T *findFirstNotEqual(const T *begin, const T *end, const T &value) {
+      constexpr std::ptrdiff_t blockSize = 16;
+      while (end - begin >= blockSize) {
+        int different = 0;
+        EASY_ITERATOR_VECTORIZE_LOOP
+        for (std::ptrdiff_t i = 0; i < blockSize; ++i) {
+          different += begin[i] != value;
+        }
+        if (different > 0) {
+          break;
+        }
+        begin += blockSize;
+      }
+      while (begin != end && *begin == value) {
+        ++begin;
+      }
+      return begin;
+    }
+
+    /**
+     * Storage for a value that is assigned later. Holds a value-initialized placeholder where
+     * possible, so that copying an unassigned value is well-defined.
+     */
+    template <class T> std::optional<T> placeholder() {
+      if constexpr (std::is_default_constructible<T>::value) {
+        return T();
+      } else {
+        return std::nullopt;
+      }
+    }
+
+    template <class T, class K> struct GroupBy : InitializedIterable {
+      static constexpr bool multiPass = iterator_detail::Source<T>::multiPass;
+      using Reference = decltype(*std::declval<iterator_detail::BeginType<T> &>());
+      using Key = std::decay_t<std::invoke_result_t<K &, Reference>>;
+
+      iterator_detail::Source<T> source;
+      K keyFunction;
+      std::optional<Key> key = placeholder<Key>();
+
+      /**
+       * Iterates the elements of the current group. Advancing the group advances the parent.
+       */
+      struct GroupIterator {
+        GroupBy *parent;
+        decltype(auto) operator*() const { return *parent->source.current; }
+        GroupIterator &operator++() {
+          ++parent->source.current;
+          return *this;
+        }
+        bool operator!=(const IterationEnd &) const { return parent->continuesGroup(); }
+        bool operator==(const IterationEnd &end) const { return !(*this != end); }
+      };
+
+      /**
+       * A view of the consecutive elements sharing the same key. Only valid until the parent
+       * iterator is advanced.
+       */
+      struct Group {
+        GroupBy *parent;
+        GroupIterator begin() const { return GroupIterator{parent}; }
+        IterationEnd end() const { return IterationEnd(); }
+      };
+
+      GroupBy(T &t, K _keyFunction) : source(t), keyFunction(std::move(_keyFunction)) {}
+
+      bool continuesGroup() { return !source.done() && keyFunction(*source.current) == *key; }
+
+      bool init() {
+        if (source.done()) {
+          return false;
+        }
+        key.emplace(keyFunction(*source.current));
+        return true;
+      }
+
+      bool advance() {
+        while (continuesGroup()) {
+          ++source.current;
+        }
+        return init();
+      }
+
+      std::pair<const Key &, Group> value() { return std::pair<const Key &, Group>(*key, {this}); }
+    };
+
+    template <class I, class E> struct RunLength : InitializedIterable {
+      static constexpr bool multiPass = iterator_detail::isMultiPass<I>;
+      using Value = std::decay_t<decltype(*std::declval<I &>())>;
+
+      I current;
+      E end;
+      std::optional<Value> runValue = placeholder<Value>();
+      size_t count = 0;
+
+      RunLength(I begin, E _end) : current(std::move(begin)), end(std::move(_end)) {}
+
+      bool init() { return advance(); }
+
+      bool advance() {
+        if (current == end) {
+          return false;
+        }
+        runValue.emplace(*current);
+        if constexpr (std::is_pointer<I>::value && std::is_arithmetic<Value>::value) {
+          auto next = findFirstNotEqual<Value>(current, end, *runValue);
+          count = next - current;
+          current += count;
+        } else {
+          count = 0;
+          while (current != end && *current == *runValue) {
+            ++current;
+            ++count;
+          }
+        }
+        return true;
+      }
+
+      std::pair<const Value &, size_t> value() {
+        return std::pair<const Value &, size_t>(*runValue, count);
+      }
+    };
+  }  // namespace group_detail
+
+  /**
+   * Lazily groups consecutive elements with equal keys, as determined by `keyFunction`, in a
+   * single pass. Yields `[key, group]` pairs where `group` iterates the group's elements without
+   * copying them. Groups are only valid until the next group is requested.
+   */
+  template <class T, class K, class = iterator_detail::NoTemporaryContainers<T>>
+  auto groupBy(T &&iterable, K &&keyFunction) {
+    using GroupBy = group_detail::GroupBy<std::remove_reference_t<T>, std::decay_t<K>>;
+    return MakeIterable<GroupBy>(GroupBy(iterable, std::forward<K>(keyFunction)));
+  }
+
+  /**
+   * Lazily yields `[value, count]` pairs for every run of consecutive equal elements. Runs in
+   * contiguous arithmetic containers are found with a vectorizable block scan.
+   */
+  template <class T, class = iterator_detail::NoTemporaryContainers<T>>
+  auto runLength(T &&iterable) {
+    if constexpr (iterator_detail::isContiguous<std::remove_reference_t<T>>) {
+      auto begin = std::data(iterable);
+      using Pointer = decltype(begin);
+      using RunLength = group_detail::RunLength<Pointer, Pointer>;
+      return MakeIterable<RunLength>(RunLength(begin, begin + std::size(iterable)));
+    } else {
+      using RunLength = group_detail::RunLength<iterator_detail::BeginType<T>,
+                                                iterator_detail::EndType<T>>;
+      return MakeIterable<RunLength>(RunLength(std::begin(iterable), std::end(iterable)));
+    }
+  }
+
+  /**
+   * A view of `N` consecutive elements starting at `data()`, as yielded by `window()`.
+   */
+  template <class T, size_t N> struct Window {
+    T *elements;
+
+    static constexpr size_t size() { return N; }
+    constexpr T *data() const { return elements; }
+    constexpr T *begin() const { return elements; }
+    constexpr T *end() const { return elements + N; }
+    constexpr T &front() const { return elements[0]; }
+    constexpr T &back() const { return elements[N - 1]; }
+    constexpr T &operator[](size_t index) const {
+      if constexpr (iterator_detail::debug) {
+        if (index >= N) {
+          throw OutOfRangeIteratorException();
+        }
+      }
+      return elements[index];
+    }
+  };
+
+  namespace iterator_detail {
+    template <class T, size_t N> struct IsView<Window<T, N>> : std::true_type {};
+  }  // namespace iterator_detail
+
+  namespace window_detail {
+    /**
+     * Windows over a contiguous array, pointing directly into the input.
+     */
+    template <class T, size_t N> struct ContiguousWindows : InitializedIterable {
+      static constexpr bool multiPass = true;
+
+      T *current, *last;
+
+      ContiguousWindows(T *begin, size_t size)
+          : current(begin), last(size < N ? begin : begin + (size - N + 1)) {}
+
+      bool init() { return current != last; }
+      bool advance() { return ++current != last; }
+      Window<T, N> value() const noexcept { return Window<T, N>{current}; }
+      size_t sizeHint() const { return size_t(last - current); }
+    };
+
+    /**
+     * Windows over any input, copied into a ring buffer of `2 * N` elements. Every element is
+     * stored twice, `N` slots apart, so that the current window is always contiguous.
+     */
+    template <class I, class E, size_t N> struct BufferedWindows : InitializedIterable {
+      static constexpr bool multiPass = iterator_detail::isMultiPass<I>;
+      using Value = std::decay_t<decltype(*std::declval<I &>())>;
+
+      I current;
+      E end;
+      std::array<Value, 2 * N> buffer{};
+      size_t start = 0;
+
+      BufferedWindows(I begin, E _end) : current(std::move(begin)), end(std::move(_end)) {}
+
+      bool push() {
+        if (current == end) {
+          return false;
+        }
+        buffer[start] = *current;
+        buffer[start + N] = buffer[start];
+        ++current;
+        if (++start == N) {
+          start = 0;
+        }
+        return true;
+      }
+
+      bool init() {
+        for (size_t i = 0; i < N; ++i) {
+          if (!push()) {
+            return false;
+          }
+        }
+        return true;
+      }
+      bool advance() { return push(); }
+      Window<const Value, N> value() const noexcept {
+        return Window<const Value, N>{buffer.data() + start};
+      }
+    };
+
+    /**
+     * Yields the two elements of each window as a tuple of references.
+     */
+    template <class W> struct Pairs : W {
+      explicit Pairs(W &&windows) : W(std::move(windows)) {}
+      auto value() const noexcept {
+        auto window = W::value();
+        return std::tuple<decltype(window[0]), decltype(window[1])>(window.front(),
+                                                                    window.back());
+      }
+    };
+
+    template <size_t N, class T> auto makeWindows(T &iterable) {
+      if constexpr (iterator_detail::isContiguous<T>) {
+        using Element = std::remove_pointer_t<decltype(std::data(iterable))>;
+        return ContiguousWindows<Element, N>(std::data(iterable), std::size(iterable));
+      } else {
+        return BufferedWindows<iterator_detail::BeginType<T>, iterator_detail::EndType<T>, N>(
+            std::begin(iterable), std::end(iterable));
+      }
+    }
+  }  // namespace window_detail
+
+  /**
+   * Yields every window of `N` consecutive elements as a `Window<T, N>` view. Windows over
+   * contiguous containers point into the container. Other inputs are copied into a fixed-size
+   * ring buffer, which requires default constructible and copy assignable values, and their
+   * windows are only valid until the next window is requested.
+   */
+  template <size_t N, class T, class = iterator_detail::NoTemporaryContainers<T>>
+  auto window(T &&iterable) {
+    static_assert(N > 0, "windows must contain at least one element");
+    using Windows = decltype(window_detail::makeWindows<N>(iterable));
+    return MakeGenerator<Windows>(window_detail::makeWindows<N>(iterable));
+  }
+
+  /**
+   * Yields every pair of consecutive elements as a tuple of references, with the same lifetime
+   * rules as `window()`.
+   */
+  template <class T, class = iterator_detail::NoTemporaryContainers<T>>
+  auto pairwise(T &&iterable) {
+    using Pairs = window_detail::Pairs<decltype(window_detail::makeWindows<2>(iterable))>;
+    return MakeGenerator<Pairs>(Pairs(window_detail::makeWindows<2>(iterable)));
+  }
+
+  namespace combinatorics_detail {
+    /**
+     * Provides indexed access to a random access container without copying it.
+     */
+    template <class T> struct ReferencedSource {
+      iterator_detail::BeginType<T> first;
+      size_t count;
+
+      explicit ReferencedSource(T &t)
+          : first(std::begin(t)), count(size_t(std::end(t) - std::begin(t))) {}
+      size_t size() const { return count; }
+      decltype(auto) operator[](size_t index) const { return first[index]; }
+    };
+
+    /**
+     * Copies the values of inputs without random access, or of temporary inputs.
+     */
+    template <class V> struct CopiedSource {
+      std::vector<V> values;
+
+      template <class T> explicit CopiedSource(T &&t) {
+        for (auto &&v : t) {
+          values.emplace_back(v);
+        }
+      }
+      size_t size() const { return values.size(); }
+      const V &operator[](size_t index) const { return values[index]; }
+    };
+
+    template <class T> using SourceFor = std::conditional_t<
+        std::is_lvalue_reference<T>::value
+            && parallel_detail::isRandomAccess<std::remove_reference_t<T>>,
+        ReferencedSource<std::remove_reference_t<T>>,
+        CopiedSource<std::decay_t<decltype(*std::begin(std::declval<T &>()))>>>;
+
+    template <class S> using Reference = decltype(std::declval<const S &>()[0]);
+
+    template <size_t, class T> using Repeat = T;
+
+    /**
+     * The product `a * b`. Throws a `SizeOverflowException` if it does not fit into `size_t`.
+     */
+    inline size_t multiply(size_t a, size_t b) {
+      if (b != 0 && a > std::numeric_limits<size_t>::max() / b) {
+        throw SizeOverflowException();
+      }
+      return a * b;
+    }
+
+    /**
+     * The binomial coefficient `n` choose `k`. Every intermediate result is itself a binomial
+     * coefficient not larger than the result, as the common divisor is cancelled before
+     * multiplying.
+     */
+    inline size_t binomial(size_t n, size_t k) {
+      if (k > n) {
+        return 0;
+      }
+      k = std::min(k, n - k);
+      size_t result = 1;
+      for (size_t i = 0; i < k; ++i) {
+        size_t divisor = std::gcd(result, i + 1);
+        result = multiply(result / divisor, (n - i) / ((i + 1) / divisor));
+      }
+      return result;
+    }
+
+    /**
+     * Random access iterator over the index space of an indexed generator `G`. Sequential steps
+     * use `G::increment()`, jumps recompute the state with `G::unrank()`.
+     */
+    template <class G> class IndexIterator {
+    private:
+      using State = typename G::State;
+
+      const G *generator = nullptr;
+      size_t index = 0;
+      State state{};
+
+      void seek(size_t target) {
+        index = target;
+        if (index < generator->size()) {
+          state = generator->unrank(index);
+        }
+      }
+
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using reference = decltype(std::declval<const G &>().dereference(std::declval<State &>()));
+      using value_type = reference;
+      using pointer = void;
+      using difference_type = std::ptrdiff_t;
+
+      IndexIterator() = default;
+      IndexIterator(const G *_generator, size_t _index) : generator(_generator) { seek(_index); }
+
+      reference operator*() const { return generator->dereference(state); }
+      reference operator[](difference_type offset) const {
+        return generator->dereference(generator->unrank(size_t(difference_type(index) + offset)));
+      }
+
+      IndexIterator &operator++() {
+        if (++index < generator->size()) {
+          generator->increment(state);
+        }
+        return *this;
+      }
+      IndexIterator operator++(int) {
+        auto copy = *this;
+        ++*this;
+        return copy;
+      }
+      IndexIterator &operator--() {
+        seek(index - 1);
+        return *this;
+      }
+      IndexIterator operator--(int) {
+        auto copy = *this;
+        --*this;
+        return copy;
+      }
+      IndexIterator &operator+=(difference_type offset) {
+        seek(size_t(difference_type(index) + offset));
+        return *this;
+      }
+      IndexIterator &operator-=(difference_type offset) { return *this += -offset; }
+      IndexIterator operator+(difference_type offset) const {
+        auto copy = *this;
+        return copy += offset;
+      }
+      IndexIterator operator-(difference_type offset) const {
+        auto copy = *this;
+        return copy -= offset;
+      }
+      friend IndexIterator operator+(difference_type offset, const IndexIterator &it) {
+        return it + offset;
+      }
+      difference_type operator-(const IndexIterator &other) const {
+        return difference_type(index) - difference_type(other.index);
+      }
+
+      bool operator==(const IndexIterator &other) const { return index == other.index; }
+      bool operator!=(const IndexIterator &other) const { return index != other.index; }
+      bool operator<(const IndexIterator &other) const { return index < other.index; }
+      bool operator>(const IndexIterator &other) const { return index > other.index; }
+      bool operator<=(const IndexIterator &other) const { return index <= other.index; }
+      bool operator>=(const IndexIterator &other) const { return index >= other.index; }
+    };
+
+    /**
+     * Iterates over the cartesian product of its sources, the last source varying fastest.
+     */
+    template <class... S> struct Product {
+      static constexpr size_t arity = sizeof...(S);
+      using State = std::array<size_t, arity>;
+
+      std::tuple<S...> sources;
+      State sizes{};
+      size_t count = 1;
+
+      explicit Product(S &&..._sources) : sources(std::move(_sources)...) {
+        sizes = std::apply([](const auto &...s) { return State{s.size()...}; }, sources);
+        for (auto size : sizes) {
+          count = multiply(count, size);
+        }
+      }
+
+      size_t size() const { return count; }
+
+      State unrank(size_t index) const {
+        State digits{};
+        for (size_t d = arity; d-- > 0;) {
+          digits[d] = index % sizes[d];
+          index /= sizes[d];
+        }
+        return digits;
+      }
+
+      void increment(State &digits) const {
+        for (size_t d = arity; d-- > 0;) {
+          if (++digits[d] < sizes[d]) {
+            return;
+          }
+          digits[d] = 0;
+        }
+      }
+
+      template <size_t... I>
+      auto dereference(const State &digits, std::index_sequence<I...>) const {
+        return std::tuple<Reference<S>...>(std::get<I>(sources)[digits[I]]...);
+      }
+      auto dereference(const State &digits) const {
+        return dereference(digits, std::index_sequence_for<S...>());
+      }
+    };
+
+    /**
+     * Iterates over the `K`-element subsets of a source in lexicographic order of indices.
+     */
+    template <class S, size_t K> struct Combinations {
+      using State = std::array<size_t, K>;
+
+      S source;
+      size_t count;
+
+      explicit Combinations(S &&_source)
+          : source(std::move(_source)), count(binomial(source.size(), K)) {}
+
+      size_t size() const { return count; }
+
+      /**
+       * Finds each index by binary search over the number of combinations skipped, which needs
+       * `O(K^2 log n)` arithmetic operations.
+       */
+      State unrank(size_t index) const {
+        State digits{};
+        size_t n = source.size(), start = 0;
+        for (size_t j = 0; j < K; ++j) {
+          size_t remaining = K - j - 1;
+          size_t total = binomial(n - start, remaining + 1), target = total - index;
+          size_t low = start, high = n - remaining - 1;
+          while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (binomial(n - middle - 1, remaining + 1) < target) {
+              high = middle;
+            } else {
+              low = middle + 1;
+            }
+          }
+          index -= total - binomial(n - low, remaining + 1);
+          digits[j] = low;
+          start = low + 1;
+        }
+        return digits;
+      }
+
+      void increment(State &digits) const {
+        size_t j = K - 1, n = source.size();
+        while (digits[j] == n - K + j) {
+          --j;
+        }
+        ++digits[j];
+        for (size_t l = j + 1; l < K; ++l) {
+          digits[l] = digits[l - 1] + 1;
+        }
+      }
+
+      template <size_t... I>
+      auto dereference(const State &digits, std::index_sequence<I...>) const {
+        return std::tuple<Repeat<I, Reference<S>>...>(source[digits[I]]...);
+      }
+      auto dereference(const State &digits) const {
+        return dereference(digits, std::make_index_sequence<K>());
+      }
+    };
+
+    /**
+     * Iterates over the ordered `K`-element arrangements of distinct elements of a source in
+     * lexicographic order of indices. The state holds the rank of every index among the indices
+     * not chosen before it, which is incremented like a mixed radix number. Converting the ranks
+     * to indices takes `O(K^2)` operations for every step and every jump.
+     */
+    template <class S, size_t K> struct Permutations {
+      struct State {
+        std::array<size_t, K> ranks, digits;
+      };
+
+      S source;
+      size_t count = 1;
+
+      explicit Permutations(S &&_source) : source(std::move(_source)) {
+        size_t n = source.size();
+        for (size_t j = 0; j < K; ++j) {
+          count = multiply(count, j < n ? n - j : 0);
+        }
+      }
+
+      size_t size() const { return count; }
+
+      static void updateDigits(State &state) {
+        std::array<size_t, K> used{};
+        for (size_t j = 0; j < K; ++j) {
+          size_t digit = state.ranks[j], position = 0;
+          while (position < j && used[position] <= digit) {
+            ++digit;
+            ++position;
+          }
+          std::copy_backward(used.begin() + position, used.begin() + j, used.begin() + j + 1);
+          used[position] = digit;
+          state.digits[j] = digit;
+        }
+      }
+
+      State unrank(size_t index) const {
+        State state;
+        size_t n = source.size();
+        for (size_t j = K; j-- > 0;) {
+          state.ranks[j] = index % (n - j);
+          index /= n - j;
+        }
+        updateDigits(state);
+        return state;
+      }
+
+      void increment(State &state) const {
+        size_t n = source.size();
+        for (size_t j = K; j-- > 0;) {
+          if (++state.ranks[j] < n - j) {
+            break;
+          }
+          state.ranks[j] = 0;
+        }
+        updateDigits(state);
+      }
+
+      template <size_t... I>
+      auto dereference(const State &state, std::index_sequence<I...>) const {
+        return std::tuple<Repeat<I, Reference<S>>...>(source[state.digits[I]]...);
+      }
+      auto dereference(const State &state) const {
+        return dereference(state, std::make_index_sequence<K>());
+      }
+    };
+  }  // namespace combinatorics_detail
+
+  /**
+   * An iterable with random access to its elements, as returned by `product()`, `combinations()`
+   * and `permutations()`. Any element can be computed directly from its index, so the index
+   * space can be split into independent slices, e.g. for processing on multiple threads.
+   * Creating a sequence with more elements than `size_t` can count throws a
+   * `SizeOverflowException`.
+   */
+  template <class G> class IndexedIterable {
+  private:
+    G generator;
+
+  public:
+    using iterator = combinatorics_detail::IndexIterator<G>;
+
+    explicit IndexedIterable(G &&_generator) : generator(std::move(_generator)) {}
+
+    size_t size() const { return generator.size(); }
+    bool empty() const { return size() == 0; }
+    iterator begin() const { return iterator(&generator, 0); }
+    iterator end() const { return iterator(&generator, size()); }
+    auto operator[](size_t index) const { return generator.dereference(generator.unrank(index)); }
+
+    /**
+     * Iterates over the elements with indices in `[first, last)`. The slice refers to this
+     * object, which must outlive it.
+     */
+    auto slice(size_t first, size_t last) const {
+      return wrap(iterator(&generator, first), iterator(&generator, last));
+    }
+  };
+
+  /**
+   * Lazily yields a tuple for every combination of elements of the arguments, equivalent to
+   * nested loops with the last argument as the innermost loop. Random access containers passed
+   * as lvalues are referenced, other arguments are copied.
+   */
+  template <class... Args> auto product(Args &&...args) {
+    static_assert(sizeof...(Args) > 0, "product requires at least one argument");
+    using Product = combinatorics_detail::Product<combinatorics_detail::SourceFor<Args>...>;
+    return IndexedIterable<Product>(
+        Product(combinatorics_detail::SourceFor<Args>(std::forward<Args>(args))...));
+  }
+
+  /**
+   * Lazily yields a tuple of `K` elements for every `K`-element subset of `iterable`, keeping the
+   * original order of elements.
+   */
+  template <size_t K, class T> auto combinations(T &&iterable) {
+    static_assert(K > 0, "combinations must contain at least one element");
+    using Source = combinatorics_detail::SourceFor<T>;
+    using Combinations = combinatorics_detail::Combinations<Source, K>;
+    return IndexedIterable<Combinations>(Combinations(Source(std::forward<T>(iterable))));
+  }
+
+  /**
+   * Lazily yields a tuple of `K` elements for every ordered arrangement of `K` distinct elements
+   * of `iterable`.
+   */
+  template <size_t K, class T> auto permutations(T &&iterable) {
+    static_assert(K > 0, "permutations must contain at least one element");
+    using Source = combinatorics_detail::SourceFor<T>;
+    using Permutations = combinatorics_detail::Permutations<Source, K>;
+    return IndexedIterable<Permutations>(Permutations(Source(std::forward<T>(iterable))));
+  }
+
+  namespace strided_detail {
+    struct Identity {
+      template <class T> constexpr T &operator()(T &value) const { return value; }
+    };
+
+    template <class M> struct Member {
+      M member;
+      template <class T> constexpr decltype(auto) operator()(T &value) const {
+        return (value.*member);
+      }
+    };
+
+    /**
+     * Random access iterator over every `stride`-th element of an array. Stores an index rather
+     * than a pointer, so that no pointer past the end of the array is ever formed.
+     */
+    template <class T, class D> class StridedIterator {
+    private:
+      T *base;
+      std::ptrdiff_t index, stride;
+      D dereferencer;
+
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using reference = decltype(std::declval<const D &>()(std::declval<T &>()));
+      using value_type = std::decay_t<reference>;
+      using pointer = std::remove_reference_t<reference> *;
+      using difference_type = std::ptrdiff_t;
+
+      constexpr StridedIterator(T *_base, std::ptrdiff_t _index, std::ptrdiff_t _stride,
+                                D _dereferencer)
+          : base(_base), index(_index), stride(_stride), dereferencer(_dereferencer) {}
+
+      constexpr reference operator*() const { return dereferencer(base[index * stride]); }
+      constexpr pointer operator->() const { return &**this; }
+      constexpr reference operator[](difference_type offset) const {
+        return dereferencer(base[(index + offset) * stride]);
+      }
+
+      constexpr StridedIterator &operator++() {
+        ++index;
+        return *this;
+      }
+      constexpr StridedIterator operator++(int) {
+        auto copy = *this;
+        ++index;
+        return copy;
+      }
+      constexpr StridedIterator &operator--() {
+        --index;
+        return *this;
+      }
+      constexpr StridedIterator operator--(int) {
+        auto copy = *this;
+        --index;
+        return copy;
+      }
+      constexpr StridedIterator &operator+=(difference_type offset) {
+        index += offset;
+        return *this;
+      }
+      constexpr StridedIterator &operator-=(difference_type offset) {
+        index -= offset;
+        return *this;
+      }
+      constexpr StridedIterator operator+(difference_type offset) const {
+        auto copy = *this;
+        return copy += offset;
+      }
+      constexpr StridedIterator operator-(difference_type offset) const {
+        auto copy = *this;
+        return copy -= offset;
+      }
+      friend constexpr StridedIterator operator+(difference_type offset,
+                                                 const StridedIterator &it) {
+        return it + offset;
+      }
+      constexpr difference_type operator-(const StridedIterator &other) const {
+        return index - other.index;
+      }
+
+      constexpr bool operator==(const StridedIterator &other) const { return index == other.index; }
+      constexpr bool operator!=(const StridedIterator &other) const { return index != other.index; }
+      constexpr bool operator<(const StridedIterator &other) const { return index < other.index; }
+      constexpr bool operator>(const StridedIterator &other) const { return index > other.index; }
+      constexpr bool operator<=(const StridedIterator &other) const {
+        return index <= other.index;
+      }
+      constexpr bool operator>=(const StridedIterator &other) const {
+        return index >= other.index;
+      }
+    };
+
+    /**
+     * A random access view of `count` elements spaced `stride` elements apart.
+     */
+    template <class T, class D> class StridedView {
+    private:
+      T *base;
+      size_t count;
+      std::ptrdiff_t stride;
+      D dereferencer;
+
+    public:
+      using iterator = StridedIterator<T, D>;
+
+      constexpr StridedView(T *_base, size_t _count, size_t _stride, D _dereferencer = D())
+          : base(_base),
+            count(_count),
+            stride(std::ptrdiff_t(_stride)),
+            dereferencer(_dereferencer) {}
+
+      constexpr size_t size() const { return count; }
+      constexpr bool empty() const { return count == 0; }
+      constexpr iterator begin() const { return iterator(base, 0, stride, dereferencer); }
+      constexpr iterator end() const {
+        return iterator(base, std::ptrdiff_t(count), stride, dereferencer);
+      }
+      constexpr typename iterator::reference operator[](size_t index) const {
+        return begin()[std::ptrdiff_t(index)];
+      }
+    };
+
+    template <size_t... K, class T, class... Planes>
+    void deinterleave(const T *input, size_t frames, std::index_sequence<K...>,
+                      Planes *...planes) {
+      constexpr size_t channels = sizeof...(Planes);
+      for (size_t frame = 0; frame < frames; ++frame) {
+        ((planes[frame] = input[frame * channels + K]), ...);
+      }
+    }
+
+    template <size_t... K, class T, class... Planes>
+    void interleave(T *output, size_t frames, std::index_sequence<K...>,
+                    const Planes *...planes) {
+      constexpr size_t channels = sizeof...(Planes);
+      for (size_t frame = 0; frame < frames; ++frame) {
+        ((output[frame * channels + K] = planes[frame]), ...);
+      }
+    }
+  }  // namespace strided_detail
+
+  namespace iterator_detail {
+    template <class T, class D> struct IsView<strided_detail::StridedView<T, D>> : std::true_type {
+    };
+  }  // namespace iterator_detail
+
+  /**
+   * A random access view of channel `index` of a contiguous array holding `channels` interleaved
+   * channels, i.e. of the elements `index`, `index + channels`, `index + 2 * channels`, ...
+   * Throws an `OutOfRangeIteratorException` in debug mode if `index` is not below `channels`.
+   */
+  template <class T, class = iterator_detail::NoTemporaryContainers<T>>
+  constexpr auto channel(T &&interleaved, size_t index, size_t channels) {
+    if constexpr (iterator_detail::debug) {
+      if (index >= channels) {
+        throw OutOfRangeIteratorException();
+      }
+    } else {
+      assert(index < channels && "channel index out of range");
+    }
+    auto data = std::data(interleaved);
+    using Element = std::remove_pointer_t<decltype(data)>;
+    return strided_detail::StridedView<Element, strided_detail::Identity>(
+        data + index, std::size(interleaved) / channels, channels);
+  }
+
+  /**
+   * A random access view of the data member `member` of every element of a contiguous array of
+   * structs. Columns of the same array can be traversed together with `zip()`.
+   */
+  template <class T, class S, class M, class = iterator_detail::NoTemporaryContainers<T>>
+  constexpr auto column(T &&structs, M S::*member) {
+    auto data = std::data(structs);
+    using Element = std::remove_pointer_t<decltype(data)>;
+    using Member = strided_detail::Member<M S::*>;
+    return strided_detail::StridedView<Element, Member>(data, std::size(structs), 1,
+                                                        Member{member});
+  }
+
+  /**
+   * Copies the channels of the contiguous array `interleaved` into the contiguous containers
+   * `planes`, one per channel. The number of channels is known at compile time, so that the
+   * compiler can vectorize the transposition. Each plane must hold at least
+   * `interleaved.size() / sizeof...(planes)` elements.
+   */
+  template <class A, class... Planes> void deinterleave(const A &interleaved, Planes &...planes) {
+    static_assert(sizeof...(Planes) > 0, "deinterleave requires at least one plane");
+    strided_detail::deinterleave(std::data(interleaved),
+                                 std::size(interleaved) / sizeof...(Planes),
+                                 std::index_sequence_for<Planes...>(), std::data(planes)...);
+  }
+
+  /**
+   * Copies the contiguous containers `planes` into the contiguous array `interleaved`, the
+   * inverse of `deinterleave()`. `interleaved` determines the number of frames copied.
+   */
+  template <class A, class... Planes> void interleave(A &interleaved, const Planes &...planes) {
+    static_assert(sizeof...(Planes) > 0, "interleave requires at least one plane");
+    strided_detail::interleave(std::data(interleaved), std::size(interleaved) / sizeof...(Planes),
+                               std::index_sequence_for<Planes...>(), std::data(planes)...);
+  }
+
+  namespace select_detail {
+    template <class R> struct Stored {
+      using type = std::decay_t<R>;
+    };
+
+    // elements of zipped iterables are stored by value, not as references into the inputs
+    template <class... Args> struct Stored<std::tuple<Args...>> {
+      using type = std::tuple<std::decay_t<Args>...>;
+    };
+
+    template <class T> using StoredValue = typename Stored<
+        std::decay_t<decltype(*std::begin(std::declval<std::remove_reference_t<T> &>()))>>::type;
+
+    /**
+     * A min-heap keeping the `k` greatest values pushed into it.
+     */
+    template <class V, class C> class BoundedHeap {
+    private:
+      std::vector<V> heap;
+      size_t k;
+      C compare;
+
+      auto order() const {
+        return [this](const V &a, const V &b) { return compare(b, a); };
+      }
+
+    public:
+      BoundedHeap(size_t _k, C _compare) : k(_k), compare(std::move(_compare)) {
+        heap.reserve(k);
+      }
+
+      bool full() const { return heap.size() == k; }
+      const V &least() const { return heap.front(); }
+      const C &comparator() const { return compare; }
+
+      template <class T> void push(T &&value) {
+        if (heap.size() < k) {
+          heap.emplace_back(std::forward<T>(value));
+          std::push_heap(heap.begin(), heap.end(), order());
+        } else if (compare(heap.front(), value)) {
+          std::pop_heap(heap.begin(), heap.end(), order());
+          heap.back() = V(std::forward<T>(value));
+          std::push_heap(heap.begin(), heap.end(), order());
+        }
+      }
+
+      std::vector<V> sorted() && {
+        std::sort_heap(heap.begin(), heap.end(), order());
+        return std::move(heap);
+      }
+    };
+
+    /**
+     * Pushes all values in `[begin, end)` into a heap with `k > 0`. For arrays of arithmetic
+     * values, blocks without any value greater than the current threshold are skipped by a
+     * vectorizable scan before touching the heap.
+     */
+    template <class V, class C, class I, class E>
+    void pushAll(BoundedHeap<V, C> &heap, I begin, E end) {
+      if constexpr (std::is_pointer<I>::value && std::is_arithmetic<V>::value) {
+        constexpr std::ptrdiff_t blockSize = 16;
+        while (!heap.full() && begin != end) {
+          heap.push(*begin++);
+        }
+        auto &compare = heap.comparator();
+        while (end - begin >= blockSize) {
+          V threshold = heap.least();
+          int candidates = 0;
+          EASY_ITERATOR_VECTORIZE_LOOP
+          for (std::ptrdiff_t i = 0; i < blockSize; ++i) {
+            candidates += compare(threshold, begin[i]);
+          }
+          if (candidates > 0) {
+            for (std::ptrdiff_t i = 0; i < blockSize; ++i) {
+              heap.push(begin[i]);
+            }
+          }
+          begin += blockSize;
+        }
+      }
+      for (; begin != end; ++begin) {
+        heap.push(*begin);
+      }
+    }
+
+    template <class T, class C>
+    std::vector<StoredValue<T>> topK(T &&iterable, size_t k, const C &compare) {
+      if (k == 0) {
+        return {};
+      }
+      BoundedHeap<StoredValue<T>, C> heap(k, compare);
+      if constexpr (iterator_detail::isContiguous<std::remove_reference_t<T>>) {
+        auto begin = std::data(iterable);
+        pushAll(heap, begin, begin + std::size(iterable));
+      } else {
+        pushAll(heap, std::begin(iterable), std::end(iterable));
+      }
+      return std::move(heap).sorted();
+    }
+  }  // namespace select_detail
+
+  /**
+   * Returns the `k` greatest elements of `iterable` according to `compare`, ordered from the
+   * greatest. Consumes any iterable in a single pass using `O(k)` memory. Elements of zipped
+   * iterables are returned as tuples of values.
+   */
+  template <class T, class C = std::less<>,
+            typename = std::enable_if_t<!execution::isExecutionPolicy<T>>>
+  auto topK(T &&iterable, size_t k, C compare = C()) {
+    return select_detail::topK(iterable, k, compare);
+  }
+
+  /**
+   * Parallel version of `topK()` using the execution policy `policy`. Every chunk of a random
+   * access input selects its own `k` greatest elements, which are merged in a final pass.
+   * For budgeted policies, the result is wrapped in an optional that is empty if the limit
+   * expired before every element was considered.
+   */
+  template <class P, class T, class C = std::less<>,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  auto topK(P &&policy, T &&iterable, size_t k, C compare = C()) {
+    using Value = select_detail::StoredValue<T>;
+    std::vector<Value> selected;
+    bool complete = true;
+    if constexpr (parallel_detail::isRandomAccess<std::remove_reference_t<T>>) {
+      if (k > 0) {
+        // contiguous inputs are passed as pointers to enable the prescreen of `pushAll()`
+        auto first = [&]() {
+          if constexpr (iterator_detail::isContiguous<std::remove_reference_t<T>>) {
+            return std::data(iterable);
+          } else {
+            return std::begin(iterable);
+          }
+        }();
+        std::vector<Value> candidates;
+        std::mutex mutex;
+        auto selectChunk = [&](size_t begin, size_t end) {
+          select_detail::BoundedHeap<Value, C> heap(k, compare);
+          select_detail::pushAll(heap, first + begin, first + end);
+          auto chunk = std::move(heap).sorted();
+          std::lock_guard<std::mutex> lock(mutex);
+          std::move(chunk.begin(), chunk.end(), std::back_inserter(candidates));
+        };
+        complete = parallel_detail::forChunks(policy, size_t(std::size(iterable)), selectChunk);
+        selected = select_detail::topK(candidates, k, compare);
+      }
+    } else if (k > 0) {
+      select_detail::BoundedHeap<Value, C> heap(k, compare);
+      complete = parallel_detail::forValues(policy, iterable, [&](auto &&value) {
+        heap.push(std::forward<decltype(value)>(value));
+      });
+      selected = std::move(heap).sorted();
+    }
+    if constexpr (execution::isBudgeted<P>) {
+      return complete ? std::optional<std::vector<Value>>(std::move(selected)) : std::nullopt;
+    } else {
+      return selected;
+    }
+  }
+
+  /**
+   * Returns the element at index `n` of `iterable` sorted from the greatest according to
+   * `compare`, or an empty optional if there are not more than `n` elements. Uses `O(n)` memory.
+   */
+  template <class T, class C = std::less<>>
+  std::optional<select_detail::StoredValue<T>> nthLargest(T &&iterable, size_t n,
+                                                          C compare = C()) {
+    auto selected = select_detail::topK(iterable, n + 1, compare);
+    if (selected.size() <= n) {
+      return std::nullopt;
+    }
+    return std::move(selected.back());
+  }
+
+  namespace scan_detail {
+    /**
+     * Yields the running combination of the elements in `[current, end)` under `op`. Exclusive
+     * scans start with the initial accumulator and exclude the current element, inclusive scans
+     * start with the first element.
+     */
+    template <class I, class E, class V, class Op, bool Exclusive> struct Scanned
+        : InitializedIterable {
+      static constexpr bool multiPass = iterator_detail::isMultiPass<I>;
+
+      I current;
+      E end;
+      std::optional<V> accumulator;
+      Op op;
+
+      Scanned(I begin, E _end, std::optional<V> init, Op _op)
+          : current(std::move(begin)),
+            end(std::move(_end)),
+            accumulator(std::move(init)),
+            op(std::move(_op)) {}
+
+      bool init() {
+        if (current == end) {
+          return false;
+        }
+        if constexpr (!Exclusive) {
+          accumulator.emplace(*current);
+        }
+        return true;
+      }
+
+      bool advance() {
+        if constexpr (Exclusive) {
+          accumulator = op(std::move(*accumulator), *current);
+          return ++current != end;
+        } else {
+          if (++current == end) {
+            return false;
+          }
+          accumulator = op(std::move(*accumulator), *current);
+          return true;
+        }
+      }
+
+      const V &value() const noexcept { return *accumulator; }
+
+      template <class J = I,
+                typename = std::enable_if_t<std::is_same<J, E>::value
+                                            && iterator_detail::hasCategory<
+                                                J, std::random_access_iterator_tag>>>
+      size_t sizeHint() const {
+        return size_t(end - current);
+      }
+    };
+
+    template <class I, class V, class Op> V reduce(I in, size_t n, V accumulator, Op &op) {
+      for (size_t i = 0; i < n; ++i, ++in) {
+        accumulator = op(std::move(accumulator), *in);
+      }
+      return accumulator;
+    }
+
+    template <bool Exclusive, class I, class O, class V, class Op>
+    V scanInto(I in, O out, size_t n, V accumulator, Op &op) {
+      for (size_t i = 0; i < n; ++i, ++in, ++out) {
+        if constexpr (Exclusive) {
+          // read the input before writing, as `in` and `out` may be the same
+          V next = op(accumulator, *in);
+          *out = std::move(accumulator);
+          accumulator = std::move(next);
+        } else {
+          accumulator = op(std::move(accumulator), *in);
+          *out = accumulator;
+        }
+      }
+      return accumulator;
+    }
+
+    /**
+     * Scans `input` into `output` using `policy` and returns the length of the longest scanned
+     * prefix of the input together with the combination of `init` with that prefix. Random access
+     * inputs are scanned in two passes if run in parallel: the first reduces every chunk and the
+     * second scans every chunk starting from the combination of all previous chunks. Under a
+     * budget, only chunks forming a prefix of the input reduced in the first pass are scanned in
+     * the second pass.
+     */
+    template <bool Exclusive, class P, class A, class B, class V, class Op>
+    std::pair<size_t, std::optional<V>> scan(const P &policy, const A &input, B &output,
+                                             std::optional<V> init, Op &op) {
+      if constexpr (parallel_detail::allRandomAccess<const A, B>) {
+        auto in = std::begin(input);
+        auto out = std::begin(output);
+        size_t size = std::size(input);
+
+        // blocks seek once and then advance step by step, as jumps may be more expensive
+        auto scanBlock = [&](size_t begin, size_t end, std::optional<V> carry) {
+          if (begin == end) {
+            return carry;
+          }
+          auto source = in + std::ptrdiff_t(begin);
+          auto target = out + std::ptrdiff_t(begin);
+          if (!carry) {
+            carry.emplace(*source);
+            *target = *carry;
+            ++source, ++target, ++begin;
+          }
+          return std::optional<V>(
+              scanInto<Exclusive>(source, target, end - begin, std::move(*carry), op));
+        };
+
+        if (!execution::isParallel<P> || size <= parallel_detail::minimumChunkSize
+            || parallel_detail::ThreadPool::global().size() == 1) {
+          auto carry = std::move(init);
+          size_t scanned = 0;
+          parallel_detail::forChunks(parallel_detail::sequenced(policy), size,
+                                     [&](size_t begin, size_t end) {
+                                       carry = scanBlock(begin, end, std::move(carry));
+                                       scanned = end;
+                                     });
+          return {scanned, std::move(carry)};
+        }
+
+        struct Block {
+          size_t begin, end;
+          V sum;
+        };
+        std::vector<Block> blocks;
+        std::mutex mutex;
+        parallel_detail::forChunks(policy, size, [&](size_t begin, size_t end) {
+          if (begin == end) {
+            return;
+          }
+          auto source = in + std::ptrdiff_t(begin);
+          V first(*source);
+          V sum = reduce(++source, end - begin - 1, std::move(first), op);
+          std::lock_guard<std::mutex> lock(mutex);
+          blocks.push_back(Block{begin, end, std::move(sum)});
+        });
+        std::sort(blocks.begin(), blocks.end(),
+                  [](const Block &a, const Block &b) { return a.begin < b.begin; });
+
+        std::vector<std::optional<V>> carries;
+        auto carry = std::move(init);
+        size_t covered = 0;
+        for (auto &block : blocks) {
+          if (block.begin != covered) {
+            break;
+          }
+          covered = block.end;
+          carries.push_back(carry);
+          if (carry) {
+            carry = op(std::move(*carry), block.sum);
+          } else {
+            carry.emplace(block.sum);
+          }
+        }
+        blocks.erase(blocks.begin() + carries.size(), blocks.end());
+
+        std::vector<char> scanned(blocks.size(), false);
+        parallel_detail::forChunks(policy, size, [&](size_t begin, size_t end) {
+          auto block = std::lower_bound(blocks.begin(), blocks.end(), begin,
+                                        [](const Block &b, size_t v) { return b.begin < v; });
+          if (block != blocks.end() && block->begin == begin) {
+            auto index = size_t(block - blocks.begin());
+            scanBlock(begin, end, carries[index]);
+            scanned[index] = true;
+          }
+        });
+        auto missing = size_t(std::find(scanned.begin(), scanned.end(), false) - scanned.begin());
+        if (missing == blocks.size()) {
+          return {covered, std::move(carry)};
+        }
+        return {blocks[missing].begin, std::move(carries[missing])};
+      } else {
+        auto carry = std::move(init);
+        size_t scanned = 0;
+        auto zipped = zip(input, output);
+        parallel_detail::forValues(policy, zipped, [&](auto values) {
+          auto &&[value, result] = values;
+          if constexpr (Exclusive) {
+            V next = op(*carry, value);
+            result = std::move(*carry);
+            carry = std::move(next);
+          } else {
+            if (carry) {
+              carry = op(std::move(*carry), value);
+            } else {
+              carry.emplace(value);
+            }
+            result = *carry;
+          }
+          ++scanned;
+        });
+        return {scanned, std::move(carry)};
+      }
+    }
+  }  // namespace scan_detail
+
+  /**
+   * Lazily yields the running combination of the elements of `iterable` under `op`, starting
+   * with the first element: `a0, op(a0, a1), op(op(a0, a1), a2), ...`.
+   */
+  template <class T, class Op = std::plus<>,
+            typename = std::enable_if_t<!execution::isExecutionPolicy<T>>,
+            class = iterator_detail::NoTemporaryContainers<T>>
+  auto inclusiveScan(T &&iterable, Op op = Op()) {
+    using Scanned = scan_detail::Scanned<iterator_detail::BeginType<T>, iterator_detail::EndType<T>,
+                                         select_detail::StoredValue<T>, Op, false>;
+    return MakeGenerator<Scanned>(
+        Scanned(std::begin(iterable), std::end(iterable), std::nullopt, std::move(op)));
+  }
+
+  /**
+   * Lazily yields the combination of `init` with all elements of `iterable` preceding the
+   * current one under `op`: `init, op(init, a0), op(op(init, a0), a1), ...`.
+   */
+  template <class T, class V, class Op = std::plus<>,
+            typename = std::enable_if_t<!execution::isExecutionPolicy<T>>,
+            class = iterator_detail::NoTemporaryContainers<T>>
+  auto exclusiveScan(T &&iterable, V init, Op op = Op()) {
+    using Scanned = scan_detail::Scanned<iterator_detail::BeginType<T>, iterator_detail::EndType<T>,
+                                         V, Op, true>;
+    return MakeGenerator<Scanned>(
+        Scanned(std::begin(iterable), std::end(iterable), std::move(init), std::move(op)));
+  }
+
+  /**
+   * Writes the inclusive scan of `input` under `op` to `output` using the execution policy
+   * `policy`, and returns the number of elements written. This is less than the size of `input`
+   * only if the limit of a budgeted policy expired, in which case the first elements of `output`
+   * up to the returned count hold their final values. `op` must be associative for parallel
+   * policies. `input` and `output` may be the same container. Behaviour is undefined if `output`
+   * is smaller than `input`.
+   */
+  template <class P, class A, class B, class Op = std::plus<>,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  size_t inclusiveScan(P &&policy, const A &input, B &output, Op op = Op()) {
+    return scan_detail::scan<false>(policy, input, output,
+                                    std::optional<select_detail::StoredValue<const A &>>(), op)
+        .first;
+  }
+
+  /**
+   * Writes the exclusive scan of `input` under `op` starting with `init` to `output` using the
+   * execution policy `policy`, and returns the combination of `init` with all elements. For
+   * example, scanning the sizes of consecutive ranges yields their offsets and the total size.
+   * If the limit of a budgeted policy expires, only a prefix of `output` is written and the
+   * result combines `init` with that prefix. `op` must be associative for parallel policies.
+   * `input` and `output` may be the same container. Behaviour is undefined if `output` is
+   * smaller than `input`.
+   */
+  template <class P, class A, class B, class V, class Op = std::plus<>,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  V exclusiveScan(P &&policy, const A &input, B &output, V init, Op op = Op()) {
+    return *scan_detail::scan<true>(policy, input, output, std::optional<V>(std::move(init)), op)
+                .second;
+  }
+
+  namespace partition_detail {
+    constexpr size_t lineSize = 64;
+
+    /**
+     * Default-constructed elements aligned to cache lines.
+     */
+    template <class V> class Storage {
+    private:
+      std::unique_ptr<char[]> memory;
+
+    public:
+      V *data = nullptr;
+      size_t size = 0;
+
+      explicit Storage(size_t _size) : memory(new char[_size * sizeof(V) + lineSize]) {
+        auto base = reinterpret_cast<uintptr_t>(memory.get());
+        auto aligned = (base + lineSize - 1) & ~uintptr_t(lineSize - 1);
+        data = reinterpret_cast<V *>(aligned);
+        std::uninitialized_default_construct_n(data, _size);
+        size = _size;
+      }
+
+      Storage(Storage &&other)
+          : memory(std::move(other.memory)),
+            data(std::exchange(other.data, nullptr)),
+            size(std::exchange(other.size, 0)) {}
+
+      Storage &operator=(Storage &&other) {
+        std::swap(memory, other.memory);
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        return *this;
+      }
+
+      ~Storage() { std::destroy_n(data, size); }
+    };
+  }  // namespace partition_detail
+
+  namespace histogram_detail {
+    /**
+     * Counts of bins up to this number are spread over several interleaved sub-histograms.
+     */
+    constexpr size_t maximumInterleavedBins = 1 << 10;
+
+    /**
+     * The number of interleaved sub-histograms. Consecutive elements falling into the same bin
+     * increment different counters, so they do not wait for each other's stores.
+     */
+    constexpr size_t lanes = 2;
+
+    struct ToIndex {
+      template <class T> constexpr size_t operator()(const T &value) const {
+        return size_t(value);
+      }
+    };
+
+    inline size_t countersFor(size_t bins) {
+      return bins <= maximumInterleavedBins ? lanes * bins : bins;
+    }
+
+    template <class K, class T> size_t binOf(K &key, size_t bins, T &&value) {
+      size_t bin = key(std::forward<T>(value));
+      if constexpr (iterator_detail::debug) {
+        if (bin >= bins) {
+          throw OutOfRangeKeyException();
+        }
+      }
+      return bin;
+    }
+
+    /**
+     * Adds the elements in `[begin, end)` to the `size` counters at `data`, which hold
+     * `countersFor(bins)` entries.
+     */
+    template <class I, class E, class K>
+    void count(size_t *data, size_t size, size_t bins, I begin, E end, K &key) {
+      if (size == bins) {
+        for (; begin != end; ++begin) {
+          ++data[binOf(key, bins, *begin)];
+        }
+        return;
+      }
+      if constexpr (std::is_same<I, E>::value
+                    && iterator_detail::hasCategory<I, std::random_access_iterator_tag>) {
+        for (; end - begin >= std::ptrdiff_t(lanes); begin += lanes) {
+          for (size_t lane = 0; lane < lanes; ++lane) {
+            ++data[lane * bins + binOf(key, bins, begin[lane])];
+          }
+        }
+      }
+      for (size_t offset = 0; begin != end; ++begin) {
+        ++data[offset + binOf(key, bins, *begin)];
+        offset = offset + bins == size ? 0 : offset + bins;
+      }
+    }
+
+    /**
+     * Adds the counts of all sub-histograms in the `size` counters at `data` to `counts`.
+     */
+    inline void addTo(std::vector<size_t> &counts, const size_t *data, size_t size) {
+      for (size_t offset = 0; offset < size; offset += counts.size()) {
+        for (size_t bin = 0; bin < counts.size(); ++bin) {
+          counts[bin] += data[offset + bin];
+        }
+      }
+    }
+  }  // namespace histogram_detail
+
+  /**
+   * Counts the elements of `iterable` by the bin `key(element)` in `[0, bins)`. Returns the
+   * count of every bin. Throws an `OutOfRangeKeyException` in debug mode for keys outside of
+   * the bins, otherwise behaviour is undefined.
+   */
+  template <class T, class K = histogram_detail::ToIndex,
+            typename = std::enable_if_t<!execution::isExecutionPolicy<T>>>
+  std::vector<size_t> histogram(T &&iterable, size_t bins, K key = K()) {
+    std::vector<size_t> counters(histogram_detail::countersFor(bins)), counts(bins);
+    histogram_detail::count(counters.data(), counters.size(), bins, std::begin(iterable),
+                            std::end(iterable), key);
+    histogram_detail::addTo(counts, counters.data(), counters.size());
+    return counts;
+  }
+
+  /**
+   * Parallel version of `histogram()` using the execution policy `policy`. Every thread counts
+   * into its own copy of the bins, which are added up once all elements have been counted. The
+   * copies occupy separate cache lines, so that threads do not invalidate each other's counters.
+   * For budgeted policies, the counts are wrapped in an optional that is empty if the limit
+   * expired before every element was counted.
+   */
+  template <class P, class T, class K = histogram_detail::ToIndex,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  auto histogram(P &&policy, T &&iterable, size_t bins, K key = K()) {
+    std::vector<size_t> counts(bins);
+    bool complete = true;
+    if constexpr (parallel_detail::isRandomAccess<std::remove_reference_t<T>>) {
+      auto first = std::begin(iterable);
+      auto size = histogram_detail::countersFor(bins);
+      // padded to whole cache lines, as the storage only aligns the first counter
+      constexpr size_t lineCounters = partition_detail::lineSize / sizeof(size_t);
+      auto padded = (size + lineCounters - 1) / lineCounters * lineCounters;
+      // every chunk takes counters not in use by another thread, so their number is bounded by
+      // the number of threads
+      std::vector<partition_detail::Storage<size_t>> all;
+      std::vector<size_t *> idle;
+      std::mutex mutex;
+      auto countChunk = [&](size_t begin, size_t end) {
+        size_t *counters;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (idle.empty()) {
+            all.emplace_back(padded);
+            counters = all.back().data;
+            std::fill_n(counters, size, size_t(0));
+          } else {
+            counters = idle.back();
+            idle.pop_back();
+          }
+        }
+        histogram_detail::count(counters, size, bins, first + begin, first + end, key);
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(counters);
+      };
+      complete = parallel_detail::forChunks(policy, size_t(std::size(iterable)), countChunk);
+      for (auto &counters : all) {
+        histogram_detail::addTo(counts, counters.data, size);
+      }
+    } else if constexpr (execution::isBudgeted<P>) {
+      complete = parallel_detail::forValues(policy, iterable, [&](auto &&value) {
+        ++counts[histogram_detail::binOf(key, bins, std::forward<decltype(value)>(value))];
+      });
+    } else {
+      counts = histogram(iterable, bins, std::move(key));
+    }
+    if constexpr (execution::isBudgeted<P>) {
+      return complete ? std::optional<std::vector<size_t>>(std::move(counts)) : std::nullopt;
+    } else {
+      return counts;
+    }
+  }
+
+  namespace partition_detail {
+    /**
+     * Partitionings into at least this number of partitions are written through write-combining
+     * buffers. With fewer partitions, the current positions of all of them stay in the cache.
+     */
+    constexpr size_t minimumBufferedFanout = 128;
+
+#ifdef EASY_ITERATOR_HAS_STREAMING_STORES
+    template <class V> static constexpr bool isStreamable
+        = std::is_trivially_copyable<V>::value && lineSize % sizeof(V) == 0;
+
+    /**
+     * Copies a cache line to the line-aligned `target`, bypassing the cache.
+     */
+    inline void streamLine(void *target, const void *source) {
+      auto to = static_cast<__m128i *>(target);
+      auto from = static_cast<const __m128i *>(source);
+      for (size_t i = 0; i < lineSize / sizeof(__m128i); ++i) {
+        _mm_stream_si128(to + i, _mm_load_si128(from + i));
+      }
+    }
+#endif
+
+    /**
+     * Writes every element in `[begin, end)` to `output` at the position `cursors[bin]` of its
+     * bin and advances the position. The positions of every bin start at `starts[bin]`.
+     * Streamable elements of many bins are first collected in a cache line sized buffer for
+     * every bin. Full lines are streamed to memory at once, avoiding reading the lines of the
+     * output into the cache.
+     */
+    template <class V, class I, class E, class K>
+    void scatter(V *output, std::vector<size_t> &cursors,
+                 [[maybe_unused]] const std::vector<size_t> &starts, I begin, E end, K &key) {
+      auto fanout = cursors.size();
+#ifdef EASY_ITERATOR_HAS_STREAMING_STORES
+      if constexpr (isStreamable<V>) {
+        if (fanout >= minimumBufferedFanout) {
+          constexpr size_t line = lineSize / sizeof(V);
+          Storage<V> buffers(fanout * line);
+          for (; begin != end; ++begin) {
+            decltype(auto) value = *begin;
+            auto bin = histogram_detail::binOf(key, fanout, value);
+            auto buffer = buffers.data + bin * line;
+            auto position = cursors[bin]++;
+            buffer[position % line] = value;
+            if ((position + 1) % line == 0) {
+              auto lineStart = position + 1 - line;
+              if (lineStart >= starts[bin]) {
+                streamLine(output + lineStart, buffer);
+              } else {
+                // the start of the line belongs to the previous bin or block
+                for (auto i = starts[bin]; i <= position; ++i) {
+                  output[i] = buffer[i % line];
+                }
+              }
+            }
+          }
+          _mm_sfence();
+          for (size_t bin = 0; bin < fanout; ++bin) {
+            auto buffer = buffers.data + bin * line;
+            auto cursor = cursors[bin];
+            for (auto i = std::max(cursor - cursor % line, starts[bin]); i < cursor; ++i) {
+              output[i] = buffer[i % line];
+            }
+          }
+          return;
+        }
+      }
+#endif
+      for (; begin != end; ++begin) {
+        decltype(auto) value = *begin;
+        output[cursors[histogram_detail::binOf(key, fanout, value)]++] = value;
+      }
+    }
+  }  // namespace partition_detail
+
+  /**
+   * The elements of an iterable grouped into partitions, which are stored consecutively in a
+   * single array. Created by `partition()`.
+   */
+  template <class V> class Partitions {
+  private:
+    partition_detail::Storage<V> storage;
+    std::vector<size_t> bounds;
+
+    template <class Q> struct PartitionAt {
+      Q *partitions;
+      auto operator()(const size_t &index) const { return (*partitions)[index]; }
+    };
+
+    template <class Q> static auto partitionIterator(Q *partitions, size_t index) {
+      return Iterator<size_t, increment::ByValue<1>, PartitionAt<Q>>(
+          index, increment::ByValue<1>(), PartitionAt<Q>{partitions});
+    }
+
+  public:
+    Partitions(partition_detail::Storage<V> &&values, std::vector<size_t> &&offsets)
+        : storage(std::move(values)), bounds(std::move(offsets)) {}
+
+    /**
+     * The number of partitions.
+     */
+    size_t size() const { return bounds.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * Iterates over the elements of the partition `index`.
+     */
+    auto operator[](size_t index) {
+      return valuesBetween(storage.data + bounds[index], storage.data + bounds[index + 1]);
+    }
+    auto operator[](size_t index) const {
+      const V *data = storage.data;
+      return valuesBetween(data + bounds[index], data + bounds[index + 1]);
+    }
+
+    /**
+     * Iterates over the partitions.
+     */
+    auto begin() { return partitionIterator(this, 0); }
+    auto end() { return partitionIterator(this, size()); }
+    auto begin() const { return partitionIterator(this, 0); }
+    auto end() const { return partitionIterator(this, size()); }
+
+    /**
+     * Iterates over the elements of all partitions, ordered by partition.
+     */
+    auto values() { return valuesBetween(storage.data, storage.data + bounds.back()); }
+    auto values() const {
+      const V *data = storage.data;
+      return valuesBetween(data, data + bounds.back());
+    }
+
+    /**
+     * The index of the first element of every partition in `values()`, followed by the total
+     * number of elements.
+     */
+    const std::vector<size_t> &offsets() const { return bounds; }
+  };
+
+  namespace partition_detail {
+    struct Block {
+      size_t begin;
+      std::vector<size_t> counts, starts;
+      bool scattered;
+    };
+
+    /**
+     * Moves the elements of all scattered blocks to the front of their partitions, removing the
+     * positions reserved for blocks skipped after a budget expired. Elements only move towards
+     * the front, so overlapping ranges are moved element by element from their first element.
+     */
+    template <class V>
+    void compact(V *values, std::vector<size_t> &offsets, const std::vector<Block> &blocks) {
+      size_t position = 0;
+      for (size_t bin = 0; bin + 1 < offsets.size(); ++bin) {
+        offsets[bin] = position;
+        for (auto &block : blocks) {
+          if (block.scattered) {
+            auto source = values + block.starts[bin], target = values + position;
+            auto count = block.counts[bin];
+            if (target + count <= source) {
+              std::move(source, source + count, target);
+            } else if (target != source) {
+              for (size_t i = 0; i < count; ++i) {
+                target[i] = std::move(source[i]);
+              }
+            }
+            position += count;
+          }
+        }
+      }
+      offsets.back() = position;
+    }
+
+    /**
+     * Partitions `[first, first + size)` in two passes using `policy`. The first pass counts the
+     * elements of every chunk by bin, which determines where every chunk writes the elements of
+     * every bin. The second pass writes the elements of all chunks to their positions.
+     */
+    template <class V, class P, class I, class K>
+    Partitions<V> partition(const P &policy, I first, size_t size, size_t fanout, K &key) {
+      std::vector<Block> blocks;
+      std::mutex mutex;
+      parallel_detail::forChunks(policy, size, [&](size_t begin, size_t end) {
+        if (begin == end) {
+          return;
+        }
+        std::vector<size_t> counters(histogram_detail::countersFor(fanout)), counts(fanout);
+        histogram_detail::count(counters.data(), counters.size(), fanout, first + begin,
+                                first + end, key);
+        histogram_detail::addTo(counts, counters.data(), counters.size());
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks.push_back(Block{begin, std::move(counts), std::vector<size_t>(fanout), false});
+      });
+      std::sort(blocks.begin(), blocks.end(),
+                [](const Block &a, const Block &b) { return a.begin < b.begin; });
+
+      // every bin stores the elements of all blocks in their original order
+      std::vector<size_t> offsets(fanout + 1);
+      size_t position = 0;
+      for (size_t bin = 0; bin < fanout; ++bin) {
+        offsets[bin] = position;
+        for (auto &block : blocks) {
+          block.starts[bin] = position;
+          position += block.counts[bin];
+        }
+      }
+      offsets[fanout] = position;
+
+      Storage<V> values(position);
+      parallel_detail::forChunks(policy, size, [&](size_t begin, size_t end) {
+        auto block = std::lower_bound(blocks.begin(), blocks.end(), begin,
+                                      [](const Block &b, size_t v) { return b.begin < v; });
+        if (block != blocks.end() && block->begin == begin) {
+          auto cursors = block->starts;
+          scatter(values.data, cursors, block->starts, first + begin, first + end, key);
+          block->scattered = true;
+        }
+      });
+      if (!std::all_of(blocks.begin(), blocks.end(), [](const Block &b) { return b.scattered; })) {
+        compact(values.data, offsets, blocks);
+      }
+      return Partitions<V>(std::move(values), std::move(offsets));
+    }
+
+    template <class P, class T, class K>
+    auto partitionAll(const P &policy, T &iterable, size_t fanout, K &key) {
+      using Value = select_detail::StoredValue<T>;
+      if constexpr (parallel_detail::isRandomAccess<T>) {
+        return partition<Value>(policy, std::begin(iterable), size_t(std::size(iterable)), fanout,
+                                key);
+      } else {
+        std::vector<Value> values;
+        for (auto &&value : parallel_detail::serial(policy, iterable)) {
+          values.emplace_back(value);
+        }
+        return partition<Value>(execution::seq, values.begin(), values.size(), fanout, key);
+      }
+    }
+  }  // namespace partition_detail
+
+  /**
+   * Groups the elements of `iterable` into `fanout` partitions by the bin `key(element)` in
+   * `[0, fanout)`, keeping their relative order. The elements are counted by bin in a first
+   * pass and copied to their partitions in a second pass, so the partitions are stored in a
+   * single array. Inputs without random access iterators are copied into a vector first.
+   * Throws an `OutOfRangeKeyException` in debug mode for keys outside of the bins, otherwise
+   * behaviour is undefined.
+   */
+  template <class T, class K = histogram_detail::ToIndex,
+            typename = std::enable_if_t<!execution::isExecutionPolicy<T>>>
+  auto partition(T &&iterable, size_t fanout, K key = K()) {
+    return partition_detail::partitionAll(execution::seq, iterable, fanout, key);
+  }
+
+  /**
+   * Parallel version of `partition()` using the execution policy `policy`. Every chunk of a
+   * random access input writes its elements to a separate range of every partition. Under a
+   * budget, elements of chunks that were not processed before the limit expired are omitted.
+   */
+  template <class P, class T, class K = histogram_detail::ToIndex,
+            typename = std::enable_if_t<execution::isExecutionPolicy<P>>>
+  auto partition(P &&policy, T &&iterable, size_t fanout, K key = K()) {
+    return partition_detail::partitionAll(policy, iterable, fanout, key);
+  }
+
+  namespace lookup_detail {
+    /**
+     * Hints the processor to load the cache line containing `address`.
+     */
+    inline void prefetch(const void *address) {
+#if defined(__GNUC__) || defined(__clang__)
+      __builtin_prefetch(address);
+#elif defined(EASY_ITERATOR_HAS_MM_PREFETCH)
+      _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+      (void)address;
+#endif
+    }
+
+    template <class C, class K, class = void> struct HasPrefetch : std::false_type {};
+
+    template <class C, class K>
+    struct HasPrefetch<C, K, std::void_t<decltype(std::declval<C &>().prefetch(std::declval<K>()))>>
+        : std::true_type {};
+
+    template <class C, class T> struct BatchedFind : InitializedIterable {
+      static constexpr bool multiPass = iterator_detail::Source<T>::multiPass;
+      using KeyIterator = iterator_detail::BeginType<T>;
+      using KeyReference = decltype(*std::declval<KeyIterator &>());
+      static constexpr bool prefetchKeys
+          = HasPrefetch<C, const std::decay_t<KeyReference> &>::value;
+      // batching only pays off if the probes of a batch can be started early
+      static constexpr size_t batchSize = prefetchKeys ? 16 : 1;
+
+      using Pointer = decltype(found(std::declval<C &>().find(std::declval<KeyReference>()),
+                                     std::declval<C &>()));
+      // keys are referenced in place when they outlive the iterator, otherwise copied
+      static constexpr bool referenceKeys
+          = std::is_lvalue_reference<KeyReference>::value
+            && iterator_detail::hasCategory<KeyIterator, std::forward_iterator_tag>;
+      using KeyStorage = std::conditional_t<referenceKeys, std::remove_reference_t<KeyReference> *,
+                                            std::decay_t<KeyReference>>;
+
+      C *container;
+      iterator_detail::Source<T> keys;
+      std::array<KeyStorage, batchSize> keyBuffer;
+      std::array<Pointer, batchSize> results;
+      size_t position = 0, count = 0;
+
+      BatchedFind(C &_container, T &_keys) : container(&_container), keys(_keys) {}
+
+      const auto &key(size_t i) const {
+        if constexpr (referenceKeys) {
+          return *keyBuffer[i];
+        } else {
+          return keyBuffer[i];
+        }
+      }
+
+      bool loadBatch() {
+        position = 0;
+        count = 0;
+        while (count < batchSize && !keys.done()) {
+          if constexpr (referenceKeys) {
+            keyBuffer[count] = &*keys.current;
+          } else {
+            keyBuffer[count] = *keys.current;
+          }
+          ++keys.current;
+          ++count;
+        }
+        if constexpr (prefetchKeys) {
+          for (size_t i = 0; i < count; ++i) {
+            container->prefetch(key(i));
+          }
+        }
+        for (size_t i = 0; i < count; ++i) {
+          results[i] = found(container->find(key(i)), *container);
+        }
+        return count > 0;
+      }
+
+      bool init() { return loadBatch(); }
+
+      bool advance() { return ++position < count || loadBatch(); }
+
+      Pointer value() { return results[position]; }
+    };
+  }  // namespace lookup_detail
+
+  /**
+   * Looks up every key of the iterable `keys` in `container` and yields the results in the
+   * `found()` convention: a pointer to the value if found, otherwise `nullptr`.
+   * If the container provides a `prefetch(key)` member, keys are resolved in batches and
+   * `prefetch` is called for the whole batch before resolving, so that the cache misses of
+   * independent probes overlap. Other containers, such as `std::unordered_map`, are probed one
+   * key at a time, as their buckets can not be prefetched without probing them.
+   * Usage: `for (auto [key, v] : zip(keys, findAll(map, keys))) { if (v) { ... } }`
+   */
+  template <class C, class T, class = iterator_detail::NoTemporaryContainers<T>>
+  auto findAll(C &container, T &&keys) {
+    using BatchedFind = lookup_detail::BatchedFind<C, std::remove_reference_t<T>>;
+    return MakeIterable<BatchedFind>(BatchedFind(container, keys));
+  }
+
+  namespace bit_detail {
+    /**
+     * Returns the index of the lowest set bit. `value` must not be zero.
+     */
+    inline int countTrailingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_ctzll(value);
+#elif defined(EASY_ITERATOR_HAS_BIT_SCAN_FORWARD_64)
+      unsigned long index;
+      _BitScanForward64(&index, value);
+      return int(index);
+#else
+      int count = 0;
+      while (!(value & 1)) {
+        value >>= 1;
+        ++count;
+      }
+      return count;
+#endif
+    }
+
+    /**
+     * Loads 8 bytes so that the byte at `data[i]` occupies bits `[8 * i, 8 * i + 8)`.
+     */
+    inline uint64_t loadLittleEndian(const void *data) {
+      uint64_t word;
+      std::memcpy(&word, data, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      word = __builtin_bswap64(word);
+#endif
+      return word;
+    }
+
+    /**
+     * Returns the number of set bits.
+     */
+    inline int popCount(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_popcountll(value);
+#else
+      value -= (value >> 1) & 0x5555555555555555ull;
+      value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+      value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+      return int((value * 0x0101010101010101ull) >> 56);
+#endif
+    }
+
+    /**
+     * Returns a mask of the lowest `count` bits of a `bits` wide word.
+     */
+    inline uint64_t lowMask(size_t count, size_t bits) {
+      return count >= bits ? ~uint64_t(0) >> (64 - bits) : (uint64_t(1) << count) - 1;
+    }
+
+    template <class W> static constexpr size_t wordBits = std::numeric_limits<W>::digits;
+
+    template <class W> constexpr void checkWordType() {
+      static_assert(std::is_unsigned<W>::value && wordBits<W> <= 64,
+                    "bit words must be unsigned integers of at most 64 bits");
+    }
+
+    /**
+     * Positions of the set bits of a single word. Each step clears the lowest set bit and finds
+     * the next one with a single bit scan.
+     */
+    struct WordBits : InitializedIterable {
+      static constexpr bool multiPass = true;
+
+      uint64_t word;
+
+      explicit WordBits(uint64_t _word) : word(_word) {}
+
+      bool init() const { return word != 0; }
+      bool advance() {
+        word &= word - 1;
+        return word != 0;
+      }
+      size_t value() const noexcept { return size_t(countTrailingZeros(word)); }
+      size_t sizeHint() const { return size_t(popCount(word)); }
+    };
+
+    /**
+     * Positions of the set bits within the first `bitCount` bits of an array of words, where
+     * bit `j` of word `i` has position `i * wordBits<W> + j`. Empty words are skipped with a
+     * single comparison.
+     */
+    template <class W> struct ArrayBits : InitializedIterable {
+      static constexpr bool multiPass = true;
+
+      const W *current, *last;
+      uint64_t word = 0, lastMask;
+      size_t offset = 0;
+
+      ArrayBits(const W *words, size_t bitCount)
+          : current(words),
+            last(words + (bitCount + wordBits<W> - 1) / wordBits<W>),
+            lastMask(lowMask((bitCount - 1) % wordBits<W> + 1, wordBits<W>)) {}
+
+      uint64_t load(const W *position) const {
+        return position + 1 == last ? uint64_t(*position) & lastMask : uint64_t(*position);
+      }
+
+      bool skipEmptyWords() {
+        while (word == 0) {
+          if (++current == last) {
+            return false;
+          }
+          offset += wordBits<W>;
+          word = load(current);
+        }
+        return true;
+      }
+
+      bool init() {
+        if (current == last) {
+          return false;
+        }
+        word = load(current);
+        return skipEmptyWords();
+      }
+      bool advance() {
+        word &= word - 1;
+        return skipEmptyWords();
+      }
+      size_t value() const noexcept { return offset + size_t(countTrailingZeros(word)); }
+      size_t sizeHint() const {
+        if (current == last) {
+          return 0;
+        }
+        size_t count = size_t(popCount(word));
+        for (auto position = current + 1; position != last; ++position) {
+          count += size_t(popCount(load(position)));
+        }
+        return count;
+      }
+    };
+
+    /**
+     * Dereferences `first` at the positions produced by the bit generator `B`.
+     */
+    template <class I, class B> struct MaskedValues : B {
+      static constexpr bool multiPass = iterator_detail::isMultiPass<I> && B::multiPass;
+
+      I first;
+
+      MaskedValues(I _first, B &&bits) : B(std::move(bits)), first(std::move(_first)) {}
+
+      decltype(auto) value() const noexcept(noexcept(std::declval<const I &>()[0])) {
+        return first[B::value()];
+      }
+    };
+
+    /**
+     * The bit generator for the first `bitCount` bits of `mask`.
+     */
+    template <class M> auto makeBits(const M &mask, size_t bitCount) {
+      if constexpr (std::is_integral<M>::value) {
+        checkWordType<M>();
+        return WordBits(uint64_t(mask) & lowMask(bitCount, wordBits<M>));
+      } else {
+        using Word = std::remove_const_t<std::remove_pointer_t<decltype(std::data(mask))>>;
+        checkWordType<Word>();
+        auto maskBits = size_t(std::size(mask)) * wordBits<Word>;
+        return ArrayBits<Word>(std::data(mask), std::min(bitCount, maskBits));
+      }
+    }
+  }  // namespace bit_detail
+
+  /**
+   * Iterates over the positions of the set bits of an unsigned integer, or of a contiguous array
+   * of unsigned integers forming a bit vector, where bit `j` of element `i` has position
+   * `i * w + j` for `w`-bit elements. Costs one step per set bit rather than per bit.
+   */
+  template <class T, class = iterator_detail::NoTemporaryContainers<T>>
+  auto setBits(T &&bits) {
+    auto generator = bit_detail::makeBits(bits, std::numeric_limits<size_t>::max());
+    return MakeGenerator<decltype(generator)>(std::move(generator));
+  }
+
+  /**
+   * Iterates over the elements of the random access container `values` whose corresponding bit
+   * in `mask` is set, yielding references. The mask is an unsigned integer or a bit vector as in
+   * `setBits()`, and bits beyond the end of `values` are ignored.
+   */
+  template <class T, class M, class = iterator_detail::NoTemporaryContainers<T, M>>
+  auto maskedValues(T &&values, M &&mask) {
+    using Bits = decltype(bit_detail::makeBits(mask, 0));
+    using Masked = bit_detail::MaskedValues<iterator_detail::BeginType<T>, Bits>;
+    return MakeGenerator<Masked>(
+        Masked(std::begin(values), bit_detail::makeBits(mask, size_t(std::size(values)))));
+  }
+
+  namespace packing_detail {
+    /**
+     * Returns the number of bits needed to represent `value`.
+     */
+    inline unsigned bitWidth(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return value ? 64 - unsigned(__builtin_clzll(value)) : 0;
+#else
+      unsigned width = 0;
+      while (value) {
+        value >>= 1;
+        ++width;
+      }
+      return width;
+#endif
+    }
+
+    /**
+     * Decodes LEB128 varints, optionally accumulating them as deltas.
+     */
+    template <bool Delta> struct Varints : InitializedIterable {
+      static constexpr bool multiPass = true;
+
+      const uint8_t *current, *end;
+      uint64_t decoded = 0;
+
+      Varints(const uint8_t *begin, const uint8_t *_end) : current(begin), end(_end) {}
+
+      bool init() { return advance(); }
+      bool advance() {
+        if (current == end) {
+          return false;
+        }
+        uint64_t result = *current & 0x7f;
+        for (unsigned shift = 7; (*current++ & 0x80) && current != end && shift < 64; shift += 7) {
+          result |= uint64_t(*current & 0x7f) << shift;
+        }
+        decoded = Delta ? decoded + result : result;
+        return true;
+      }
+      uint64_t value() const noexcept { return decoded; }
+    };
+
+    template <bool Delta, class T> auto varints(const T &bytes) {
+      static_assert(sizeof(*std::data(bytes)) == 1, "varints are decoded from byte arrays");
+      auto begin = reinterpret_cast<const uint8_t *>(std::data(bytes));
+      return MakeGenerator<Varints<Delta>>(begin, begin + std::size(bytes));
+    }
+
+    template <bool Delta, class T> std::vector<uint8_t> encodeVarints(const T &values) {
+      std::vector<uint8_t> bytes;
+      uint64_t previous = 0;
+      for (auto &&v : values) {
+        uint64_t remaining = Delta ? uint64_t(v) - previous : uint64_t(v);
+        previous = uint64_t(v);
+        while (remaining >= 0x80) {
+          bytes.push_back(uint8_t(remaining | 0x80));
+          remaining >>= 7;
+        }
+        bytes.push_back(uint8_t(remaining));
+      }
+      return bytes;
+    }
+  }  // namespace packing_detail
+
+  /**
+   * Lazily decodes the unsigned LEB128 varints stored in a contiguous byte array.
+   */
+  template <class T> auto varints(const T &bytes) {
+    return packing_detail::varints<false>(bytes);
+  }
+
+  /**
+   * Lazily decodes varints stored as differences to their predecessor, as produced by
+   * `encodeDeltaVarints()`, e.g. for sorted ids.
+   */
+  template <class T> auto deltaVarints(const T &bytes) {
+    return packing_detail::varints<true>(bytes);
+  }
+
+  /**
+   * Encodes integers as unsigned LEB128 varints.
+   */
+  template <class T> std::vector<uint8_t> encodeVarints(const T &values) {
+    return packing_detail::encodeVarints<false>(values);
+  }
+
+  /**
+   * Encodes integers as varints of the difference to their predecessor.
+   */
+  template <class T> std::vector<uint8_t> encodeDeltaVarints(const T &values) {
+    return packing_detail::encodeVarints<true>(values);
+  }
+
+  /**
+   * A column of integers compressed in blocks of `blockSize` values. Every block stores a
+   * reference value and packs the offsets of its values with the smallest sufficient bit width.
+   * With `Delta == false` the offsets are relative to the smallest value of the block
+   * (frame-of-reference), otherwise to the preceding value, which suits sorted data.
+   * Iteration decodes one block at a time into a small buffer, and `from()` and `lowerBound()`
+   * seek without decoding the skipped blocks.
+   */
+  template <class T, bool Delta = false> class PackedColumn {
+  public:
+    static constexpr size_t blockSize = 128;
+
+  private:
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 8,
+                  "packed columns store integers of at most 64 bits");
+
+    struct Block {
+      uint64_t reference;
+      size_t offset;
+      unsigned bits;
+    };
+
+    // signed values are stored with a flipped sign bit, which preserves their order
+    static constexpr uint64_t signFlip = std::is_signed<T>::value ? uint64_t(1) << 63 : 0;
+
+    static uint64_t toKey(T value) { return uint64_t(int64_t(value)) ^ signFlip; }
+    static T fromKey(uint64_t key) { return T(key ^ signFlip); }
+
+    std::vector<Block> blocks;
+    // every block occupies `2 * bits` words, followed by a padding word for unaligned reads
+    std::vector<uint64_t> words;
+    size_t count = 0;
+
+    void encodeBlock(const uint64_t *values, size_t length) {
+      std::array<uint64_t, blockSize> offsets{};
+      uint64_t reference = values[0], maximum = 0;
+      if constexpr (!Delta) {
+        reference = *std::min_element(values, values + length);
+      }
+      for (size_t i = 0; i < length; ++i) {
+        offsets[i] = values[i] - (Delta && i > 0 ? values[i - 1] : reference);
+        maximum |= offsets[i];
+      }
+      auto bits = packing_detail::bitWidth(maximum);
+      auto offset = words.size() - 1;
+      blocks.push_back(Block{reference, offset, bits});
+      words.resize(words.size() + 2 * bits);
+      for (size_t i = 0; bits > 0 && i < length; ++i) {
+        auto bit = i * bits, shift = bit % 64;
+        auto word = words.data() + offset + bit / 64;
+        word[0] |= offsets[i] << shift;
+        if (shift + bits > 64) {
+          word[1] |= offsets[i] >> (64 - shift);
+        }
+      }
+    }
+
+  public:
+    /**
+     * Decodes a column from a given position, for use with `MakeGenerator`.
+     */
+    class Decoder : public InitializedIterable {
+    private:
+      const PackedColumn *column;
+      size_t index, blockEnd = 0;
+      std::array<T, blockSize> buffer{};
+
+    public:
+      static constexpr bool multiPass = true;
+
+      Decoder(const PackedColumn *_column, size_t start) : column(_column), index(start) {}
+
+      bool init() {
+        if (index >= column->size()) {
+          return false;
+        }
+        blockEnd = column->decodeBlock(index / blockSize, buffer.data());
+        return true;
+      }
+      bool advance() {
+        if (++index == blockEnd) {
+          if (index == column->size()) {
+            return false;
+          }
+          blockEnd = column->decodeBlock(index / blockSize, buffer.data());
+        }
+        return true;
+      }
+      T value() const noexcept { return buffer[index % blockSize]; }
+      size_t sizeHint() const { return column->size() - index; }
+    };
+
+    PackedColumn() = default;
+
+    template <class I> explicit PackedColumn(const I &values) {
+      std::array<uint64_t, blockSize> block;
+      size_t length = 0;
+      words.push_back(0);
+      for (auto &&v : values) {
+        block[length++] = toKey(T(v));
+        if (length == blockSize) {
+          encodeBlock(block.data(), length);
+          count += length;
+          length = 0;
+        }
+      }
+      if (length > 0) {
+        encodeBlock(block.data(), length);
+        count += length;
+      }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /**
+     * The number of bytes occupied by the compressed data.
+     */
+    size_t compressedSize() const {
+      return words.size() * sizeof(uint64_t) + blocks.size() * sizeof(Block);
+    }
+
+    /**
+     * Decodes all `blockSize` values of block `index` into `output` and returns the index one
+     * past the last valid value of the block. Unpacking runs a fixed number of iterations without
+     * branches, which allows the compiler to vectorize it.
+     */
+    size_t decodeBlock(size_t index, T *output) const {
+      auto &block = blocks[index];
+      auto data = words.data() + block.offset;
+      auto mask = block.bits == 64 ? ~uint64_t(0) : (uint64_t(1) << block.bits) - 1;
+      std::array<uint64_t, blockSize> offsets;
+      for (size_t i = 0; i < blockSize; ++i) {
+        auto bit = i * block.bits, shift = bit % 64;
+        auto low = data[bit / 64], high = data[std::min(bit / 64 + 1, 2 * size_t(block.bits))];
+        offsets[i] = ((low >> shift) | ((high << 1) << (63 - shift))) & mask;
+      }
+      if constexpr (Delta) {
+        uint64_t current = block.reference;
+        for (size_t i = 0; i < blockSize; ++i) {
+          current += offsets[i];
+          output[i] = fromKey(current);
+        }
+      } else {
+        for (size_t i = 0; i < blockSize; ++i) {
+          output[i] = fromKey(block.reference + offsets[i]);
+        }
+      }
+      return std::min(count, (index + 1) * blockSize);
+    }
+
+    /**
+     * Iterates over the values starting at position `index`, skipping the preceding blocks.
+     */
+    auto from(size_t index) const { return MakeGenerator<Decoder>(this, index); }
+
+    auto begin() const { return from(0).begin(); }
+    auto end() const { return IterationEnd(); }
+
+    /**
+     * The position of the first value not less than `value` in a sorted column. Finds the block
+     * by binary search over the block reference values and decodes only that block.
+     */
+    size_t lowerBound(const T &value) const {
+      auto byReference
+          = [](const Block &block, const T &v) { return fromKey(block.reference) < v; };
+      auto next = std::lower_bound(blocks.begin(), blocks.end(), value, byReference);
+      if (next == blocks.begin()) {
+        return 0;
+      }
+      auto index = size_t(next - blocks.begin()) - 1;
+      std::array<T, blockSize> buffer;
+      auto end = decodeBlock(index, buffer.data()) - index * blockSize;
+      return index * blockSize + size_t(std::lower_bound(buffer.data(), buffer.data() + end, value)
+                                        - buffer.data());
+    }
+  };
+
+  /**
+   * A sorted associative container storing its entries contiguously in a single array.
+   * Lookups use a branchless binary search and iteration is a linear scan, which makes it
+   * considerably faster than `std::map` for small to medium tables that are rarely modified.
+   * Insertion and removal are `O(n)`. Compatible with `find`, `found` and `eraseIfFound`.
+   * Keys must not be modified through iterators.
+   */
+  template <class K, class V, class Compare = std::less<K>> class FlatMap {
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = size_t;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  private:
+    std::vector<value_type> entries;
+    Compare compare;
+
+    template <class Key> size_t lowerBoundIndex(const Key &key) const {
+      size_t length = entries.size();
+      if (length == 0) {
+        return 0;
+      }
+      const value_type *base = entries.data();
+      while (length > 1) {
+        auto half = length / 2;
+        base = compare(base[half - 1].first, key) ? base + half : base;
+        length -= half;
+      }
+      return size_t(base - entries.data()) + compare(base->first, key);
+    }
+
+    template <class Key> bool matches(size_t index, const Key &key) const {
+      return index < entries.size() && !compare(key, entries[index].first);
+    }
+
+  public:
+    FlatMap() = default;
+
+    explicit FlatMap(Compare _compare) : compare(std::move(_compare)) {}
+
+    /**
+     * Constructs the map from the given entries. For duplicate keys the first entry is kept.
+     */
+    FlatMap(std::initializer_list<value_type> values, Compare _compare = Compare())
+        : entries(values), compare(std::move(_compare)) {
+      auto byKey = [this](const value_type &a, const value_type &b) {
+        return compare(a.first, b.first);
+      };
+      std::stable_sort(entries.begin(), entries.end(), byKey);
+      auto equalKeys = [this](const value_type &a, const value_type &b) {
+        return !compare(a.first, b.first) && !compare(b.first, a.first);
+      };
+      entries.erase(std::unique(entries.begin(), entries.end(), equalKeys), entries.end());
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+    void reserve(size_t capacity) { entries.reserve(capacity); }
+
+    template <class Key> iterator lower_bound(const Key &key) {
+      return entries.begin() + lowerBoundIndex(key);
+    }
+
+    template <class Key> const_iterator lower_bound(const Key &key) const {
+      return entries.begin() + lowerBoundIndex(key);
+    }
+
+    template <class Key> iterator find(const Key &key) {
+      auto index = lowerBoundIndex(key);
+      return matches(index, key) ? entries.begin() + index : entries.end();
+    }
+
+    template <class Key> const_iterator find(const Key &key) const {
+      auto index = lowerBoundIndex(key);
+      return matches(index, key) ? entries.begin() + index : entries.end();
+    }
+
+    template <class Key> size_t count(const Key &key) const {
+      return matches(lowerBoundIndex(key), key);
+    }
+
+    /**
+     * Inserts a value constructed from `args` if `key` is not yet contained.
+     */
+    template <class... Args> std::pair<iterator, bool> try_emplace(const K &key, Args &&...args) {
+      auto index = lowerBoundIndex(key);
+      if (matches(index, key)) {
+        return std::make_pair(entries.begin() + index, false);
+      }
+      auto it = entries.emplace(entries.begin() + index, std::piecewise_construct,
+                                std::forward_as_tuple(key),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+      return std::make_pair(it, true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) {
+      return try_emplace(value.first, value.second);
+    }
+
+    V &operator[](const K &key) { return try_emplace(key).first->second; }
+
+    iterator erase(iterator it) { return entries.erase(it); }
+    iterator erase(const_iterator it) { return entries.erase(it); }
+
+    template <class Key> size_t erase(const Key &key) { return eraseIfFound(find(key), *this); }
+  };
+
+  namespace hash_map_detail {
+    constexpr int8_t emptyControl = -128;
+    constexpr int8_t deletedControl = -2;
+    constexpr size_t groupSize = 8;
+    constexpr uint64_t lowBits = 0x0101010101010101ull;
+    constexpr uint64_t highBits = 0x8080808080808080ull;
+
+    /**
+     * Spreads the bits of `hash` over the whole word by folding the high half of its 128 bit
+     * product with the golden ratio into the low half. Standard library hashes map integers to
+     * themselves, which would otherwise send consecutive keys to the same group.
+     */
+    inline uint64_t mix(uint64_t hash) {
+      constexpr uint64_t factor = 0x9E3779B97F4A7C15ull;
+#if defined(__SIZEOF_INT128__)
+      __extension__ typedef unsigned __int128 Wide;
+      auto product = Wide(hash) * factor;
+      return uint64_t(product) ^ uint64_t(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+      uint64_t high;
+      uint64_t low = _umul128(hash, factor, &high);
+      return low ^ high;
+#else
+      uint64_t a = hash >> 32, b = hash & 0xFFFFFFFF, c = factor >> 32, d = factor & 0xFFFFFFFF;
+      uint64_t bd = b * d, ad = a * d, bc = b * c;
+      uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF);
+      uint64_t high = a * c + (ad >> 32) + (bc >> 32) + (middle >> 32);
+      return hash * factor ^ high;
+#endif
+    }
+
+    /**
+     * Control bytes of a group of 8 slots, matched against a pattern in parallel using a single
+     * 64 bit word. Each set high bit of a returned mask marks a matching slot.
+     */
+    struct Group {
+      uint64_t word;
+
+      explicit Group(const int8_t *control) : word(bit_detail::loadLittleEndian(control)) {}
+
+      // may report false positives next to a true match, which are rejected by the key comparison
+      uint64_t match(int8_t hash) const {
+        auto x = word ^ (lowBits * uint8_t(hash));
+        return (x - lowBits) & ~x & highBits;
+      }
+
+      // empty is the only control value with the high bit set and bit 1 unset
+      uint64_t matchEmpty() const { return word & ~(word << 6) & highBits; }
+
+      uint64_t matchEmptyOrDeleted() const { return word & highBits; }
+
+      static size_t firstIndex(uint64_t mask) {
+        return size_t(bit_detail::countTrailingZeros(mask)) / 8;
+      }
+    };
+
+    template <class T> union Slot {
+      T value;
+      Slot() {}
+      ~Slot() {}
+    };
+
+    template <class Value, class SlotType> class Iterator {
+    private:
+      const int8_t *control;
+      SlotType *slots;
+      size_t index, capacity;
+
+      template <class, class> friend class Iterator;
+
+      void skipEmpty() {
+        while (index < capacity && control[index] < 0) {
+          ++index;
+        }
+      }
+
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = std::remove_const_t<Value>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = Value *;
+      using reference = Value &;
+
+      Iterator(const int8_t *_control, SlotType *_slots, size_t _index, size_t _capacity)
+          : control(_control), slots(_slots), index(_index), capacity(_capacity) {
+        skipEmpty();
+      }
+
+      template <class OtherValue, class OtherSlot,
+                typename = std::enable_if_t<std::is_convertible<OtherValue *, Value *>::value>>
+      Iterator(const Iterator<OtherValue, OtherSlot> &other)
+          : control(other.control), slots(other.slots), index(other.index),
+            capacity(other.capacity) {}
+
+      Value &operator*() const { return slots[index].value; }
+      Value *operator->() const { return &slots[index].value; }
+
+      Iterator &operator++() {
+        ++index;
+        skipEmpty();
+        return *this;
+      }
+
+      size_t slotIndex() const { return index; }
+
+      template <class OtherValue, class OtherSlot>
+      bool operator==(const Iterator<OtherValue, OtherSlot> &other) const {
+        return index == other.index;
+      }
+
+      template <class OtherValue, class OtherSlot>
+      bool operator!=(const Iterator<OtherValue, OtherSlot> &other) const {
+        return index != other.index;
+      }
+    };
+  }  // namespace hash_map_detail
+
+  /**
+   * An open-addressing hash map storing its entries in a single contiguous slot array.
+   * Every slot has a control byte holding 7 bits of the key's hash, and 8 control bytes are
+   * compared at once when probing, so that most lookups touch a single group of slots.
+   * Compatible with `find`, `found`, `eraseIfFound` and `findAll`, which uses `prefetch`.
+   * Iterators are invalidated by insertion.
+   */
+  template <class K, class V, class Hash = std::hash<K>, class Equal = std::equal_to<K>>
+  class HashMap {
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = size_t;
+
+  private:
+    using Slot = hash_map_detail::Slot<value_type>;
+    using Group = hash_map_detail::Group;
+
+  public:
+    using iterator = hash_map_detail::Iterator<value_type, Slot>;
+    using const_iterator = hash_map_detail::Iterator<const value_type, const Slot>;
+
+  private:
+    std::unique_ptr<int8_t[]> control;
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity = 0, entryCount = 0, deleted = 0;
+    Hash hash;
+    Equal equal;
+
+    static int8_t controlHash(uint64_t h) { return int8_t(h & 0x7F); }
+
+    size_t groupMask() const { return capacity / hash_map_detail::groupSize - 1; }
+
+    size_t firstGroup(uint64_t h) const { return size_t(h >> 7) & groupMask(); }
+
+    template <class Key> uint64_t hashOf(const Key &key) const {
+      return hash_map_detail::mix(uint64_t(hash(key)));
+    }
+
+    /**
+     * The slot of `key`, or `capacity` if not contained. Stores the number of probed groups in
+     * `probed` if given.
+     */
+    template <class Key> size_t findIndex(const Key &key, size_t *probed = nullptr) const {
+      if (capacity == 0) {
+        return 0;
+      }
+      auto h = hashOf(key);
+      auto group = firstGroup(h);
+      for (size_t step = 1;; ++step) {
+        if (probed) {
+          *probed = step;
+        }
+        auto offset = group * hash_map_detail::groupSize;
+        Group controlGroup(control.get() + offset);
+        for (auto mask = controlGroup.match(controlHash(h)); mask; mask &= mask - 1) {
+          auto index = offset + Group::firstIndex(mask);
+          if (control[index] >= 0 && equal(slots[index].value.first, key)) {
+            return index;
+          }
+        }
+        if (controlGroup.matchEmpty()) {
+          return capacity;
+        }
+        group = (group + step) & groupMask();
+      }
+    }
+
+    size_t findInsertIndex(uint64_t h) const {
+      auto group = firstGroup(h);
+      for (size_t step = 1;; ++step) {
+        auto offset = group * hash_map_detail::groupSize;
+        auto mask = Group(control.get() + offset).matchEmptyOrDeleted();
+        if (mask) {
+          return offset + Group::firstIndex(mask);
+        }
+        group = (group + step) & groupMask();
+      }
+    }
+
+    void rehash(size_t newCapacity) {
+      auto oldControl = std::move(control);
+      auto oldSlots = std::move(slots);
+      auto oldCapacity = capacity;
+      control.reset(new int8_t[newCapacity]);
+      std::fill(control.get(), control.get() + newCapacity, hash_map_detail::emptyControl);
+      slots.reset(new Slot[newCapacity]);
+      capacity = newCapacity;
+      deleted = 0;
+      for (size_t i = 0; i < oldCapacity; ++i) {
+        if (oldControl[i] >= 0) {
+          auto h = hashOf(oldSlots[i].value.first);
+          auto index = findInsertIndex(h);
+          control[index] = controlHash(h);
+          new (&slots[index].value) value_type(std::move(oldSlots[i].value));
+          oldSlots[i].value.~value_type();
+        }
+      }
+    }
+
+    void reserveForInsert() {
+      if ((entryCount + deleted + 1) * 8 > capacity * 7) {
+        auto newCapacity = std::max(capacity, hash_map_detail::groupSize * 2);
+        while ((entryCount + 1) * 8 > newCapacity * 7 / 2) {
+          newCapacity *= 2;
+        }
+        rehash(newCapacity);
+      }
+    }
+
+    void destroyAll() {
+      for (size_t i = 0; i < capacity; ++i) {
+        if (control[i] >= 0) {
+          slots[i].value.~value_type();
+          control[i] = hash_map_detail::emptyControl;
+        }
+      }
+      entryCount = 0;
+      deleted = 0;
+    }
+
+  public:
+    HashMap() = default;
+
+    HashMap(std::initializer_list<value_type> values) {
+      reserve(values.size());
+      for (auto &value : values) {
+        insert(value);
+      }
+    }
+
+    HashMap(const HashMap &other) : hash(other.hash), equal(other.equal) {
+      reserve(other.size());
+      for (auto &value : other) {
+        insert(value);
+      }
+    }
+
+    HashMap(HashMap &&other) noexcept { swap(other); }
+
+    HashMap &operator=(HashMap other) {
+      swap(other);
+      return *this;
+    }
+
+    ~HashMap() { destroyAll(); }
+
+    void swap(HashMap &other) noexcept {
+      std::swap(control, other.control);
+      std::swap(slots, other.slots);
+      std::swap(capacity, other.capacity);
+      std::swap(entryCount, other.entryCount);
+      std::swap(deleted, other.deleted);
+      std::swap(hash, other.hash);
+      std::swap(equal, other.equal);
+    }
+
+    iterator begin() { return iterator(control.get(), slots.get(), 0, capacity); }
+    iterator end() { return iterator(control.get(), slots.get(), capacity, capacity); }
+    const_iterator begin() const {
+      return const_iterator(control.get(), slots.get(), 0, capacity);
+    }
+    const_iterator end() const {
+      return const_iterator(control.get(), slots.get(), capacity, capacity);
+    }
+
+    size_t size() const { return entryCount; }
+    bool empty() const { return entryCount == 0; }
+    void clear() { destroyAll(); }
+
+    /**
+     * Allocates enough slots to hold `size` entries without rehashing.
+     */
+    void reserve(size_t size) {
+      size_t newCapacity = hash_map_detail::groupSize;
+      while (size * 8 > newCapacity * 7) {
+        newCapacity *= 2;
+      }
+      if (newCapacity > capacity) {
+        rehash(newCapacity);
+      }
+    }
+
+    template <class Key> iterator find(const Key &key) {
+      return iterator(control.get(), slots.get(), findIndex(key), capacity);
+    }
+
+    template <class Key> const_iterator find(const Key &key) const {
+      return const_iterator(control.get(), slots.get(), findIndex(key), capacity);
+    }
+
+    template <class Key> size_t count(const Key &key) const { return findIndex(key) != capacity; }
+
+    /**
+     * The number of groups of slots probed by a lookup of `key`, which indicates the quality of
+     * the hash function.
+     */
+    template <class Key> size_t probeLength(const Key &key) const {
+      size_t probed = 0;
+      findIndex(key, &probed);
+      return probed;
+    }
+
+    /**
+     * Loads the control bytes and slots probed first by a lookup of `key` into the cache.
+     */
+    template <class Key> void prefetch(const Key &key) const {
+      if (capacity > 0) {
+        auto offset = firstGroup(hashOf(key)) * hash_map_detail::groupSize;
+        lookup_detail::prefetch(control.get() + offset);
+        lookup_detail::prefetch(slots.get() + offset);
+      }
+    }
+
+    /**
+     * Inserts a value constructed from `args` if `key` is not yet contained.
+     */
+    template <class... Args> std::pair<iterator, bool> try_emplace(const K &key, Args &&...args) {
+      auto index = findIndex(key);
+      if (index != capacity) {
+        return std::make_pair(iterator(control.get(), slots.get(), index, capacity), false);
+      }
+      reserveForInsert();
+      auto h = hashOf(key);
+      index = findInsertIndex(h);
+      new (&slots[index].value) value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                                           std::forward_as_tuple(std::forward<Args>(args)...));
+      if (control[index] == hash_map_detail::deletedControl) {
+        --deleted;
+      }
+      control[index] = controlHash(h);
+      ++entryCount;
+      return std::make_pair(iterator(control.get(), slots.get(), index, capacity), true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) {
+      return try_emplace(value.first, value.second);
+    }
+
+    V &operator[](const K &key) { return try_emplace(key).first->second; }
+
+    iterator erase(iterator it) { return erase(const_iterator(it)); }
+
+    iterator erase(const_iterator it) {
+      auto index = it.slotIndex();
+      slots[index].value.~value_type();
+      auto groupOffset = index - index % hash_map_detail::groupSize;
+      // probes can only pass through a group without free slots, otherwise they stop there
+      if (Group(control.get() + groupOffset).matchEmpty()) {
+        control[index] = hash_map_detail::emptyControl;
+      } else {
+        control[index] = hash_map_detail::deletedControl;
+        ++deleted;
+      }
+      --entryCount;
+      return iterator(control.get(), slots.get(), index, capacity);
+    }
+
+    template <class Key> size_t erase(const Key &key) { return eraseIfFound(find(key), *this); }
+  };
+
+  namespace collect_detail {
+    template <class I, class E, class = void> struct HasDifference : std::false_type {};
+
+    template <class I, class E> using Difference
+        = decltype(std::declval<const E &>() - std::declval<const I &>());
+
+    template <class I, class E> struct HasDifference<I, E, std::void_t<Difference<I, E>>>
+        : std::is_convertible<Difference<I, E>, std::ptrdiff_t> {};
+
+    template <class I> struct IsZipIterator : std::false_type {};
+
+    template <class... Args, class D, class C>
+    struct IsZipIterator<Iterator<std::tuple<Args...>, increment::ByTupleIncrement, D, C>>
+        : std::true_type {};
+
+    /**
+     * Returns the number of elements between `begin` and `end` if it can be determined without
+     * iterating, otherwise `-1`. The length of a `zip` is determined by its last iterator and
+     * generators may provide a hint through `sizeHint()`.
+     */
+    template <class I, class E> std::ptrdiff_t sizeHint(const I &begin, const E &end) {
+      if constexpr (HasDifference<I, E>::value) {
+        return end - begin;
+      } else if constexpr (iterator_detail::HasSizeHint<I>::value) {
+        return begin.sizeHint();
+      } else if constexpr (IsZipIterator<I>::value && IsZipIterator<E>::value) {
+        constexpr auto last = std::tuple_size<decltype(begin.value)>::value - 1;
+        return sizeHint(std::get<last>(begin.value), std::get<last>(end.value));
+      } else {
+        return -1;
+      }
+    }
+
+    template <class C, class = void> struct HasReserve : std::false_type {};
+
+    template <class C>
+    struct HasReserve<C, std::void_t<decltype(std::declval<C &>().reserve(size_t()))>>
+        : std::true_type {};
+
+    template <class C, class V, class = void> struct HasPushBack : std::false_type {};
+
+    template <class C, class V> struct HasPushBack<
+        C, V, std::void_t<decltype(std::declval<C &>().push_back(std::declval<V>()))>>
+        : std::true_type {};
+
+    template <class T> struct IsTuple : std::false_type {};
+    template <class... Args> struct IsTuple<std::tuple<Args...>> : std::true_type {};
+
+    /**
+     * The type storing a value of type `T`. Tuples and pairs of references, e.g. yielded by
+     * `zip`, are stored as tuples and pairs of values, so that the result does not alias the
+     * iterated containers.
+     */
+    template <class T> struct Stored { using type = T; };
+    template <class... Args> struct Stored<std::tuple<Args...>> {
+      using type = std::tuple<std::decay_t<Args>...>;
+    };
+    template <class A, class B> struct Stored<std::pair<A, B>> {
+      using type = std::pair<std::decay_t<A>, std::decay_t<B>>;
+    };
+
+    /**
+     * Passes on `value` if it can be stored as `Target`, otherwise constructs `Target` from the
+     * elements of the tuple `value`, e.g. to collect a `zip` into a `std::map`.
+     */
+    template <class Target, class V> decltype(auto) convert(V &&value) {
+      if constexpr (!std::is_constructible<Target, V &&>::value
+                    && IsTuple<std::decay_t<V>>::value) {
+        return std::make_from_tuple<Target>(std::forward<V>(value));
+      } else {
+        return std::forward<V>(value);
+      }
+    }
+  }  // namespace collect_detail
+
+  /**
+   * A monotonic memory arena. Allocations bump a pointer into a list of blocks and are only
+   * released all at once by `reset()`, which keeps the blocks for reuse. Not thread-safe.
+   */
+  class MonotonicArena {
+  private:
+    std::vector<std::pair<std::unique_ptr<char[]>, size_t>> blocks;
+    size_t block = 0, offset = 0, initialSize;
+
+  public:
+    explicit MonotonicArena(size_t _initialSize = 4096) : initialSize(_initialSize) {}
+
+    MonotonicArena(const MonotonicArena &) = delete;
+
+    /**
+     * Returns `size` bytes aligned to `alignment`, which must be a power of two.
+     */
+    void *allocate(size_t size, size_t alignment) {
+      while (block < blocks.size()) {
+        auto base = reinterpret_cast<uintptr_t>(blocks[block].first.get());
+        auto aligned = (base + offset + alignment - 1) & ~uintptr_t(alignment - 1);
+        if (aligned + size <= base + blocks[block].second) {
+          offset = aligned + size - base;
+          return reinterpret_cast<void *>(aligned);
+        }
+        ++block;
+        offset = 0;
+      }
+      auto blockSize = std::max(blocks.empty() ? initialSize : blocks.back().second * 2,
+                                size + alignment);
+      blocks.emplace_back(std::unique_ptr<char[]>(new char[blockSize]), blockSize);
+      return allocate(size, alignment);
+    }
+
+    /**
+     * Releases all allocations at once. Memory obtained from the arena must no longer be used.
+     */
+    void reset() {
+      block = 0;
+      offset = 0;
+    }
+
+    /**
+     * The total number of bytes held by the arena.
+     */
+    size_t capacity() const {
+      size_t total = 0;
+      for (auto &b : blocks) {
+        total += b.second;
+      }
+      return total;
+    }
+  };
+
+  /**
+   * A standard allocator drawing memory from a `MonotonicArena`. Deallocation is a no-op.
+   */
+  template <class T> class ArenaAllocator {
+  private:
+    MonotonicArena *arena;
+
+    template <class> friend class ArenaAllocator;
+
+  public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MonotonicArena &_arena) : arena(&_arena) {}
+
+    template <class U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+      if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        throw std::bad_array_new_length();
+      }
+      return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) {}
+
+    template <class U> bool operator==(const ArenaAllocator<U> &other) const {
+      return arena == other.arena;
+    }
+
+    template <class U> bool operator!=(const ArenaAllocator<U> &other) const {
+      return arena != other.arena;
+    }
+  };
+
+  /**
+   * Materialises an iterable into a container of type `Container`, by default a `std::vector`
+   * of the iterable's values. If the number of elements is known in advance, e.g. for
+   * containers, `range`, `zip` and `enumerate`, the container reserves exactly that size.
+   * Otherwise it grows geometrically. Optional arguments, such as an allocator, are passed
+   * to the container's constructor. By default, tuples of references such as those of `zip`
+   * are stored as tuples of copied values.
+   * Usage: `auto squares = collect(zip(range(10), values));`
+   */
+  template <class Container = void, class T, class... Args>
+  auto collect(T &&iterable, Args &&...args) {
+    auto begin = std::begin(iterable);
+    auto end = std::end(iterable);
+    using Value = typename collect_detail::Stored<std::decay_t<decltype(*begin)>>::type;
+    using Result
+        = std::conditional_t<std::is_void<Container>::value, std::vector<Value>, Container>;
+    Result result(std::forward<Args>(args)...);
+    if constexpr (collect_detail::HasReserve<Result>::value) {
+      auto size = collect_detail::sizeHint(begin, end);
+      if (size > 0) {
+        result.reserve(size_t(size));
+      }
+    }
+    using Converted = decltype(collect_detail::convert<typename Result::value_type>(*begin));
+    for (; begin != end; ++begin) {
+      if constexpr (collect_detail::HasPushBack<Result, Converted>::value) {
+        result.push_back(collect_detail::convert<typename Result::value_type>(*begin));
+      } else {
+        result.insert(result.end(), collect_detail::convert<typename Result::value_type>(*begin));
+      }
+    }
+    return result;
+  }
+
+  namespace static_detail {
+    template <class T> using Element
+        = std::conditional_t<std::is_lvalue_reference<T>::value, T, std::decay_t<T>>;
+
+    template <class T> using Indices
+        = std::make_index_sequence<std::tuple_size<std::remove_reference_t<T>>::value>;
+
+    template <size_t... I> constexpr auto indexTuple(std::index_sequence<I...>) {
+      return std::make_tuple(std::integral_constant<size_t, I>()...);
+    }
+
+    template <class F, size_t... I> constexpr void forEachIndex(F &f, std::index_sequence<I...>) {
+      (f(std::integral_constant<size_t, I>()), ...);
+    }
+
+    template <size_t I, class... Args> constexpr auto zipElement(Args &&...args) {
+      return std::tuple<Element<decltype(std::get<I>(std::forward<Args>(args)))>...>(
+          std::get<I>(std::forward<Args>(args))...);
+    }
+
+    template <size_t... I, class... Args>
+    constexpr auto zip(std::index_sequence<I...>, Args &&...args) {
+      return std::make_tuple(zipElement<I>(std::forward<Args>(args)...)...);
+    }
+  }  // namespace static_detail
+
+  /**
+   * Returns a tuple of the compile-time indices `0` to `N - 1` as `std::integral_constant`s.
+   */
+  template <size_t N> constexpr auto staticRange() {
+    return static_detail::indexTuple(std::make_index_sequence<N>());
+  }
+
+  /**
+   * Calls `f(std::integral_constant<size_t, I>())` for every `I` from `0` to `N - 1`. The calls
+   * are expanded at compile time, so the index can be used as a constant expression in `f`.
+   * Usage: `forEachStatic<4>([&](auto i) { std::get<i>(tuple) = i; });`
+   */
+  template <size_t N, class F> constexpr void forEachStatic(F &&f) {
+    static_detail::forEachIndex(f, std::make_index_sequence<N>());
+  }
+
+  /**
+   * Calls `f` for every element of the tuple-like object `t`, e.g. a `std::tuple`, `std::pair`
+   * or `std::array`. The calls are expanded at compile time and may use different types.
+   */
+  template <class T, class F> constexpr void forEachStatic(T &&t, F &&f) {
+    std::apply([&](auto &&...elements) { (f(std::forward<decltype(elements)>(elements)), ...); },
+               std::forward<T>(t));
+  }
+
+  /**
+   * Zips tuple-like objects of the same size into a tuple of tuples, the compile-time
+   * counterpart of `zip`. Elements of lvalue arguments are referenced, others are copied.
+   * Usage: `forEachStatic(staticZip(a, b), [](auto pair) { auto [x, y] = pair; });`
+   */
+  template <class T, class... Args> constexpr auto staticZip(T &&first, Args &&...rest) {
+    static_assert(((std::tuple_size<std::remove_reference_t<T>>::value
+                    == std::tuple_size<std::remove_reference_t<Args>>::value)
+                   && ...),
+                  "staticZip requires arguments of the same size");
+    return static_detail::zip(static_detail::Indices<T>(), std::forward<T>(first),
+                              std::forward<Args>(rest)...);
+  }
+
+  /**
+   * Returns a tuple of `[index, element]` tuples for the tuple-like object `t`, where each
+   * index is a `std::integral_constant`. The compile-time counterpart of `enumerate`.
+   */
+  template <class T> constexpr auto staticEnumerate(T &&t) {
+    return staticZip(static_detail::indexTuple(static_detail::Indices<T>()), std::forward<T>(t));
+  }
+
 }  // namespace easy_iterator
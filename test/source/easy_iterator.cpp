@@ -1,10 +1,20 @@
 #include <doctest/doctest.h>
 #include <easy_iterator.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <functional>
+#include <iterator>
+#include <list>
 #include <map>
+#include <numeric>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 using namespace easy_iterator;
@@ -357,3 +367,1913 @@ TEST_CASE("found") {
   REQUIRE(&find(map, "a")->second == &map["a"]);
   REQUIRE(!find(map, "c"));
 }
+
+TEST_CASE("execution policies") {
+  std::vector<int> large(1 << 20), target(large.size());
+
+  SUBCASE("fill") {
+    fill(execution::par, large, 42);
+    REQUIRE(std::all_of(large.begin(), large.end(), [](int v) { return v == 42; }));
+    fill(execution::seq, large, 3);
+    REQUIRE(std::all_of(large.begin(), large.end(), [](int v) { return v == 3; }));
+  }
+
+  SUBCASE("copy") {
+    copy(execution::par, range(int(large.size())), large);
+    copy(execution::par_unseq, large, target, [](int v) { return 2 * v; });
+    bool correct = true;
+    for (auto [i, v] : enumerate(target)) {
+      correct &= v == 2 * int(i);
+    }
+    REQUIRE(correct);
+  }
+
+  SUBCASE("forEach") {
+    std::vector<int> small(10);
+    copy(execution::seq, range(10), small);
+    forEach(
+        execution::par, [](int a, int &b) { b = a + 1; }, small, small);
+    for (auto [i, v] : enumerate(small)) {
+      REQUIRE(v == i + 1);
+    }
+    forEach(
+        execution::par, [](auto a, int &b) { b = a; }, range(10), small);
+    for (auto [i, v] : enumerate(small)) {
+      REQUIRE(v == i);
+    }
+  }
+
+  SUBCASE("exceptions") {
+    auto throwing = [](int &) { throw std::out_of_range("out of range"); };
+    REQUIRE_THROWS_AS(forEach(execution::par, throwing, large), std::out_of_range);
+  }
+}
+
+TEST_CASE("sorted operations") {
+  std::vector<int> a{1, 3, 5, 7, 9, 11}, b{2, 3, 4, 9, 10, 11, 12}, c{3, 9, 11, 15};
+
+  SUBCASE("merge") {
+    std::vector<int> merged;
+    for (auto &v : merge(a, b, c)) {
+      merged.push_back(v);
+    }
+    std::vector<int> expected(a);
+    expected.insert(expected.end(), b.begin(), b.end());
+    expected.insert(expected.end(), c.begin(), c.end());
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(merged == expected);
+  }
+
+  SUBCASE("merge ranges") {
+    std::vector<int> merged;
+    for (auto v : merge(range(0, 10, 3), range(1, 10, 3), range(2, 10, 3))) {
+      merged.push_back(v);
+    }
+    REQUIRE(merged == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7});
+  }
+
+  SUBCASE("mergeAll") {
+    std::vector<std::vector<int>> lists{a, {}, b, c};
+    std::vector<int> merged;
+    for (auto v : mergeAll(lists)) {
+      merged.push_back(v);
+    }
+    REQUIRE(std::is_sorted(merged.begin(), merged.end()));
+    REQUIRE(merged.size() == a.size() + b.size() + c.size());
+    std::vector<std::vector<int>> empty;
+    REQUIRE(!mergeAll(empty).begin());
+  }
+
+  SUBCASE("intersect") {
+    std::vector<int> matches;
+    for (auto [x, y, z] : intersect(a, b, c)) {
+      REQUIRE(&x != &y);
+      REQUIRE(x == y);
+      REQUIRE(y == z);
+      matches.push_back(x);
+    }
+    REQUIRE(matches == std::vector<int>{3, 9, 11});
+  }
+
+  SUBCASE("intersect skewed") {
+    std::vector<int> large(10000);
+    copy(range(10000), large);
+    std::vector<int> small{0, 17, 4096, 9999, 20000};
+    std::vector<int> matches;
+    for (auto [x, y] : intersect(small, large)) {
+      REQUIRE(&y == &large[y]);
+      matches.push_back(x);
+    }
+    REQUIRE(matches == std::vector<int>{0, 17, 4096, 9999});
+  }
+
+  SUBCASE("intersect with generator") {
+    std::vector<int> matches;
+    for (auto [x, y] : intersect(range(0, 12, 2), a)) {
+      matches.push_back(x);
+    }
+    REQUIRE(matches.empty());
+    for (auto [x, y] : intersect(range(0, 12, 2), b)) {
+      matches.push_back(y);
+    }
+    REQUIRE(matches == std::vector<int>{2, 4, 10});
+  }
+
+  SUBCASE("difference") {
+    std::vector<int> result;
+    for (auto v : difference(a, b)) {
+      result.push_back(v);
+    }
+    REQUIRE(result == std::vector<int>{1, 5, 7});
+    result.clear();
+    std::vector<int> duplicates{1, 1, 2, 2, 2}, once{1, 2};
+    for (auto v : difference(duplicates, once)) {
+      result.push_back(v);
+    }
+    REQUIRE(result == std::vector<int>{1, 2, 2});
+  }
+
+  SUBCASE("temporary containers") {
+    using Vector = std::vector<int>;
+    auto merging = [](auto &&...args) -> decltype(merge(std::forward<decltype(args)>(args)...)) {
+      return merge(std::forward<decltype(args)>(args)...);
+    };
+    auto intersecting
+        = [](auto &&...args) -> decltype(intersect(std::forward<decltype(args)>(args)...)) {
+      return intersect(std::forward<decltype(args)>(args)...);
+    };
+    auto subtracting
+        = [](auto &&...args) -> decltype(difference(std::forward<decltype(args)>(args)...)) {
+      return difference(std::forward<decltype(args)>(args)...);
+    };
+    REQUIRE(std::is_invocable_v<decltype(merging), Vector &, Vector &>);
+    REQUIRE(!std::is_invocable_v<decltype(merging), Vector &, Vector>);
+    REQUIRE(!std::is_invocable_v<decltype(merging), Vector, Vector>);
+    REQUIRE(std::is_invocable_v<decltype(intersecting), decltype(range(3)), Vector &>);
+    REQUIRE(!std::is_invocable_v<decltype(intersecting), Vector &, Vector>);
+    REQUIRE(std::is_invocable_v<decltype(subtracting), Vector &, Vector &>);
+    REQUIRE(!std::is_invocable_v<decltype(subtracting), Vector, Vector &>);
+  }
+}
+
+TEST_CASE("groupBy") {
+  std::vector<std::pair<int, std::string>> records{
+      {1, "a"}, {1, "b"}, {2, "c"}, {3, "d"}, {3, "e"}, {3, "f"}};
+  auto key = [](const auto &record) { return record.first; };
+
+  SUBCASE("iterate groups") {
+    std::vector<int> keys;
+    std::vector<std::string> values;
+    for (auto [k, group] : groupBy(records, key)) {
+      keys.push_back(k);
+      std::string joined;
+      for (auto &record : group) {
+        REQUIRE(record.first == k);
+        joined += record.second;
+      }
+      values.push_back(joined);
+    }
+    REQUIRE(keys == std::vector<int>{1, 2, 3});
+    REQUIRE(values == std::vector<std::string>{"ab", "c", "def"});
+  }
+
+  SUBCASE("skip groups") {
+    std::vector<int> keys;
+    for (auto [k, group] : groupBy(records, key)) {
+      keys.push_back(k);
+      if (k == 3) {
+        for (auto &record : group) {
+          REQUIRE(record.second == "d");
+          break;
+        }
+      }
+    }
+    REQUIRE(keys == std::vector<int>{1, 2, 3});
+  }
+
+  SUBCASE("generator input") {
+    std::vector<std::pair<int, int>> groups;
+    for (auto [k, group] : groupBy(range(10), [](int v) { return v / 4; })) {
+      int count = 0;
+      for (auto v : group) {
+        REQUIRE(v / 4 == k);
+        ++count;
+      }
+      groups.emplace_back(k, count);
+    }
+    REQUIRE(groups == std::vector<std::pair<int, int>>{{0, 4}, {1, 4}, {2, 2}});
+  }
+
+  SUBCASE("empty") {
+    records.clear();
+    REQUIRE(!groupBy(records, key).begin());
+  }
+
+  SUBCASE("temporary containers") {
+    using Records = decltype(records);
+    auto grouping = [&](auto &&iterable)
+        -> decltype(groupBy(std::forward<decltype(iterable)>(iterable), key)) {
+      return groupBy(std::forward<decltype(iterable)>(iterable), key);
+    };
+    REQUIRE(std::is_invocable_v<decltype(grouping), Records &>);
+    REQUIRE(!std::is_invocable_v<decltype(grouping), Records>);
+  }
+}
+
+TEST_CASE("runLength") {
+  std::vector<std::pair<int, size_t>> expected{{1, 3}, {2, 40}, {1, 1}, {5, 17}};
+  std::vector<int> values;
+  for (auto [v, count] : expected) {
+    values.insert(values.end(), count, v);
+  }
+
+  SUBCASE("contiguous") {
+    std::vector<std::pair<int, size_t>> runs;
+    for (auto [v, count] : runLength(values)) {
+      runs.emplace_back(v, count);
+    }
+    REQUIRE(runs == expected);
+  }
+
+  SUBCASE("iterators") {
+    std::vector<std::pair<int, size_t>> runs;
+    for (auto [v, count] : runLength(valuesBetween(values.data(), values.data() + values.size()))) {
+      runs.emplace_back(v, count);
+    }
+    REQUIRE(runs == expected);
+  }
+
+  SUBCASE("strings") {
+    std::vector<std::string> strings{"a", "a", "b"};
+    std::vector<std::pair<std::string, size_t>> runs;
+    for (auto [v, count] : runLength(strings)) {
+      runs.emplace_back(v, count);
+    }
+    REQUIRE(runs == std::vector<std::pair<std::string, size_t>>{{"a", 2}, {"b", 1}});
+  }
+
+  SUBCASE("temporary containers") {
+    auto counting = [](auto &&iterable)
+        -> decltype(runLength(std::forward<decltype(iterable)>(iterable))) {
+      return runLength(std::forward<decltype(iterable)>(iterable));
+    };
+    REQUIRE(std::is_invocable_v<decltype(counting), std::vector<int> &>);
+    REQUIRE(std::is_invocable_v<decltype(counting), decltype(range(3))>);
+    REQUIRE(!std::is_invocable_v<decltype(counting), std::vector<int>>);
+  }
+}
+
+TEST_CASE("findAll") {
+  std::unordered_map<int, std::string> map;
+  for (auto i : range(0, 100, 3)) {
+    map[i] = std::to_string(i);
+  }
+  std::vector<int> keys(50);
+  copy(range(50), keys);
+
+  SUBCASE("unordered_map") {
+    size_t count = 0;
+    for (auto [key, value] : zip(keys, findAll(map, keys))) {
+      REQUIRE(value == find(map, key));
+      count++;
+    }
+    REQUIRE(count == keys.size());
+  }
+
+  SUBCASE("map with generated keys") {
+    std::map<int, int> ordered{{1, 2}, {3, 4}};
+    std::vector<const std::pair<const int, int> *> results;
+    for (auto value : findAll(std::as_const(ordered), range(5))) {
+      results.push_back(value);
+    }
+    REQUIRE(results.size() == 5);
+    REQUIRE(results[0] == nullptr);
+    REQUIRE(results[1] == &*ordered.find(1));
+    REQUIRE(results[3]->second == 4);
+  }
+
+  SUBCASE("prefetch") {
+    struct PrefetchingMap : std::unordered_map<int, std::string> {
+      size_t prefetched = 0;
+      void prefetch(int) { prefetched++; }
+    } prefetchingMap;
+    prefetchingMap[4] = "4";
+    size_t hits = 0;
+    for (auto value : findAll(prefetchingMap, keys)) {
+      if (value) {
+        REQUIRE(value->first == 4);
+        hits++;
+      }
+    }
+    REQUIRE(hits == 1);
+    REQUIRE(prefetchingMap.prefetched == keys.size());
+  }
+
+  SUBCASE("temporary keys") {
+    auto finding = [&](auto &&iterable)
+        -> decltype(findAll(map, std::forward<decltype(iterable)>(iterable))) {
+      return findAll(map, std::forward<decltype(iterable)>(iterable));
+    };
+    REQUIRE(std::is_invocable_v<decltype(finding), std::vector<int> &>);
+    REQUIRE(std::is_invocable_v<decltype(finding), decltype(range(3))>);
+    REQUIRE(!std::is_invocable_v<decltype(finding), std::vector<int>>);
+  }
+
+  SUBCASE("empty") {
+    keys.clear();
+    REQUIRE(!findAll(map, keys).begin());
+  }
+}
+
+TEST_CASE("flat containers") {
+  auto testMap = [](auto map) {
+    map["a"] = 1;
+    map["b"] = 2;
+    REQUIRE(map.size() == 2);
+    REQUIRE(found(map.find("a"), map));
+    REQUIRE(&found(map.find("a"), map)->second == &map["a"]);
+    REQUIRE(!found(map.find("c"), map));
+    REQUIRE(find(map, "b")->second == 2);
+    REQUIRE(find(std::as_const(map), "b")->second == 2);
+    REQUIRE(!find(map, "c"));
+    REQUIRE(!map.try_emplace("a", 3).second);
+    REQUIRE(map["a"] == 1);
+    REQUIRE(eraseIfFound(map.find("a"), map));
+    REQUIRE(!eraseIfFound(map.find("c"), map));
+    REQUIRE(map.find("a") == map.end());
+    REQUIRE(map.size() == 1);
+    REQUIRE(map.erase(std::string("b")) == 1);
+    REQUIRE(map.empty());
+  };
+
+  SUBCASE("FlatMap") { testMap(FlatMap<std::string, int>()); }
+
+  SUBCASE("HashMap") { testMap(HashMap<std::string, int>()); }
+
+  SUBCASE("FlatMap order") {
+    FlatMap<int, int> map{{3, 0}, {1, 1}, {2, 2}, {1, 3}};
+    std::vector<int> keys, values;
+    for (auto &[key, value] : map) {
+      keys.push_back(key);
+      values.push_back(value);
+    }
+    REQUIRE(keys == std::vector<int>{1, 2, 3});
+    REQUIRE(values == std::vector<int>{1, 2, 0});
+    for (auto i : range(-2, 6)) {
+      REQUIRE(map.count(i) == (i >= 1 && i <= 3));
+      REQUIRE(map.lower_bound(i) - map.begin() == std::min(std::max(i - 1, 0), 3));
+    }
+  }
+
+  SUBCASE("HashMap stress") {
+    HashMap<int, int> map;
+    std::unordered_map<int, int> reference;
+    unsigned state = 1;
+    for (auto i : range(20000)) {
+      state = state * 1103515245 + 12345;
+      int key = (state >> 8) % 2000;
+      if (state & 0x10) {
+        REQUIRE(map.erase(key) == reference.erase(key));
+      } else {
+        map[key] = i;
+        reference[key] = i;
+      }
+      REQUIRE(map.size() == reference.size());
+    }
+    size_t visited = 0;
+    for (auto [key, value] : enumerate(map)) {
+      REQUIRE(reference.at(value.first) == value.second);
+      visited = key + 1;
+    }
+    REQUIRE(visited == reference.size());
+    for (auto [key, value] : zip(range(2000), findAll(map, range(2000)))) {
+      REQUIRE(bool(value) == bool(reference.count(key)));
+    }
+    auto copy = map;
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(copy.size() == reference.size());
+    REQUIRE(find(copy, reference.begin()->first)->second == reference.begin()->second);
+  }
+
+  SUBCASE("HashMap sequential keys") {
+    // std::hash maps integers to themselves, so consecutive keys must be spread by the map
+    HashMap<size_t, size_t> map;
+    size_t count = 100000;
+    for (auto i : range(count)) {
+      map[i] = i;
+    }
+    size_t total = 0, longest = 0;
+    for (auto i : range(count)) {
+      auto length = map.probeLength(i);
+      total += length;
+      longest = std::max(longest, length);
+      REQUIRE(map.find(i)->second == i);
+    }
+    REQUIRE(total < 2 * count);
+    REQUIRE(longest <= 16);
+  }
+}
+
+TEST_CASE("collect") {
+  SUBCASE("range") {
+    auto values = collect(range(2, 12, 3));
+    static_assert(std::is_same<decltype(values), std::vector<int>>::value);
+    REQUIRE(values == std::vector<int>{2, 5, 8});
+    REQUIRE(values.capacity() == 3);
+  }
+
+  SUBCASE("zip and enumerate") {
+    std::vector<int> integers{4, 5, 6};
+    auto pairs = collect<std::vector<std::pair<size_t, int>>>(enumerate(integers));
+    REQUIRE(pairs == std::vector<std::pair<size_t, int>>{{0, 4}, {1, 5}, {2, 6}});
+    REQUIRE(pairs.capacity() == 3);
+    auto tuples = collect(zip(range(3), integers));
+    static_assert(std::is_same<decltype(tuples), std::vector<std::tuple<int, int>>>::value);
+    REQUIRE(tuples.capacity() == 3);
+    REQUIRE(std::get<1>(tuples[2]) == 6);
+    integers[2] = 7;
+    REQUIRE(std::get<1>(tuples[2]) == 6);
+  }
+
+  SUBCASE("generator") {
+    struct Countdown {
+      unsigned current = 5;
+      bool advance() { return current-- > 1; }
+      unsigned value() { return current; }
+    };
+    REQUIRE(collect(MakeIterable<Countdown>()) == std::vector<unsigned>{5, 4, 3, 2, 1});
+  }
+
+  SUBCASE("other containers") {
+    auto set = collect<std::map<int, int>>(zip(range(3), range(3, 6)));
+    REQUIRE(set.size() == 3);
+    REQUIRE(set[1] == 4);
+  }
+
+  SUBCASE("arena") {
+    MonotonicArena arena(64);
+    using Vector = std::vector<int, ArenaAllocator<int>>;
+    for (auto pass : range(3)) {
+      auto values = collect<Vector>(range(100), ArenaAllocator<int>(arena));
+      REQUIRE(values.size() == 100);
+      REQUIRE(values[99] == 99);
+      REQUIRE(values.get_allocator() == ArenaAllocator<int>(arena));
+      auto capacity = arena.capacity();
+      arena.reset();
+      if (pass > 0) {
+        REQUIRE(arena.capacity() == capacity);
+      }
+    }
+    ArenaAllocator<uint64_t> allocator(arena);
+    REQUIRE_THROWS_AS(allocator.allocate(std::numeric_limits<size_t>::max() / 4),
+                      std::bad_array_new_length);
+  }
+}
+
+namespace constexpr_tests {
+  constexpr int rangeSum(int n) {
+    int sum = 0;
+    for (auto i : range(n)) {
+      sum += i;
+    }
+    return sum;
+  }
+
+  constexpr std::array<int, 8> squares() {
+    std::array<int, 8> result{};
+    for (auto [i, v] : enumerate(result)) {
+      v = int(i * i);
+    }
+    return result;
+  }
+
+  constexpr int zipProduct() {
+    std::array<int, 4> a{1, 2, 3, 4}, b{5, 6, 7, 8};
+    int sum = 0;
+    for (auto [x, y, z] : zip(a, b, range(4))) {
+      sum += x * y + z;
+    }
+    return sum;
+  }
+
+  struct Powers {
+    unsigned current = 1;
+    constexpr bool advance() {
+      current *= 2;
+      return current < 1000;
+    }
+    constexpr unsigned value() { return current; }
+  };
+
+  constexpr unsigned powerCount() {
+    unsigned count = 0;
+    for (auto v : MakeIterable<Powers>()) {
+      count += v > 0;
+    }
+    return count;
+  }
+
+  constexpr int pointerSum() {
+    int values[] = {1, 2, 3};
+    int sum = 0;
+    for (auto v : valuesBetween(values, values + 3)) {
+      sum += v;
+    }
+    return sum;
+  }
+
+  static_assert(rangeSum(10) == 45);
+  static_assert(squares()[7] == 49);
+  static_assert(zipProduct() == 5 + 12 + 21 + 32 + 6);
+  static_assert(powerCount() == 10);
+  static_assert(pointerSum() == 6);
+}  // namespace constexpr_tests
+
+TEST_CASE("constexpr") {
+  constexpr auto table = constexpr_tests::squares();
+  for (auto [i, v] : enumerate(table)) {
+    REQUIRE(v == i * i);
+  }
+}
+
+namespace static_tests {
+  constexpr size_t indexSum() {
+    size_t sum = 0;
+    forEachStatic<5>([&](auto i) {
+      static_assert(decltype(i)::value < 5);
+      sum += i;
+    });
+    return sum;
+  }
+
+  constexpr size_t tupleIndexSum() {
+    size_t sum = 0;
+    forEachStatic(staticRange<5>(), [&](auto i) { sum += std::integral_constant<size_t, i>(); });
+    return sum;
+  }
+
+  static_assert(indexSum() == 10);
+  static_assert(tupleIndexSum() == 10);
+  static_assert(std::tuple_size<decltype(staticRange<0>())>::value == 0);
+}  // namespace static_tests
+
+TEST_CASE("static iteration") {
+  SUBCASE("heterogeneous tuple") {
+    std::tuple<int, double, std::string> tuple(1, 2.5, "three");
+    std::vector<std::string> strings;
+    forEachStatic(tuple, [&](const auto &v) {
+      std::ostringstream stream;
+      stream << v;
+      strings.push_back(stream.str());
+    });
+    REQUIRE(strings == std::vector<std::string>{"1", "2.5", "three"});
+  }
+
+  SUBCASE("staticZip") {
+    std::array<int, 3> a{1, 2, 3};
+    std::tuple<int, long, short> b(0, 0, 0);
+    forEachStatic(staticZip(a, b), [](auto pair) {
+      auto [x, y] = pair;
+      y = 2 * x;
+    });
+    REQUIRE(b == std::make_tuple(2, 4l, short(6)));
+  }
+
+  SUBCASE("staticEnumerate") {
+    std::array<int, 4> values{};
+    forEachStatic(staticEnumerate(values), [](auto pair) {
+      auto [i, v] = pair;
+      using Index = std::integral_constant<size_t, decltype(i)::value>;
+      static_assert(std::is_same<decltype(i), Index>::value);
+      v = int(i);
+    });
+    REQUIRE(values == std::array<int, 4>{0, 1, 2, 3});
+  }
+
+  SUBCASE("matrix") {
+    std::array<std::array<int, 4>, 4> matrix{};
+    forEachStatic<4>([&](auto i) { forEachStatic<4>([&](auto j) { matrix[i][j] = i * 4 + j; }); });
+    for (auto [i, row] : enumerate(matrix)) {
+      for (auto [j, v] : enumerate(row)) {
+        REQUIRE(v == i * 4 + j);
+      }
+    }
+  }
+}
+
+#if EASY_ITERATOR_DEBUG
+
+TEST_CASE("debug mode") {
+  std::vector<int> values(5);
+  auto iterate = [](auto &&iterable) {
+    size_t count = 0;
+    for (auto v : iterable) {
+      static_cast<void>(v);
+      ++count;
+    }
+    return count;
+  };
+
+  SUBCASE("zip length mismatch") {
+    REQUIRE_THROWS_AS(iterate(zip(range(4), values)), ZipLengthMismatchException);
+    REQUIRE_THROWS_AS(iterate(zip(values, range(6))), ZipLengthMismatchException);
+    REQUIRE(iterate(zip(range(5), values)) == 5);
+    REQUIRE(iterate(enumerate(values)) == 5);
+  }
+
+  SUBCASE("reused iterable") {
+    auto numbers = range(3);
+    REQUIRE(iterate(numbers) == 3);
+    REQUIRE(iterate(numbers) == 3);
+
+    struct Once {
+      std::unique_ptr<int> data = std::make_unique<int>(0);
+      bool advance() { return false; }
+      int value() { return *data; }
+    };
+    MakeIterable<Once> once;
+    REQUIRE(iterate(once) == 1);
+    REQUIRE_THROWS_AS(iterate(once), ReusedIterableException);
+  }
+
+  SUBCASE("out of range") {
+    auto between = valuesBetween(values.data() + 1, values.data() + 3);
+    auto it = between.begin();
+    REQUIRE(&*it == &values[1]);
+    ++it;
+    REQUIRE(&*it == &values[2]);
+    ++it;
+    REQUIRE_THROWS_AS(*it, OutOfRangeIteratorException);
+  }
+}
+
+#endif
+
+TEST_CASE("MakeGenerator") {
+  struct Countdown {
+    unsigned current;
+    explicit Countdown(unsigned start) : current(start) {}
+    bool advance() { return current-- > 0; }
+    unsigned value() const noexcept { return current; }
+    size_t sizeHint() const { return current + 1; }
+  };
+
+  SUBCASE("iterate") {
+    auto it = MakeGenerator<Countdown>(1).begin();
+    static_assert(noexcept(*it));
+    REQUIRE(it != IterationEnd());
+    REQUIRE(*it == 1);
+    REQUIRE(it.sizeHint() == 2);
+    ++it;
+    REQUIRE(*it == 0);
+    ++it;
+    REQUIRE(it == IterationEnd());
+    REQUIRE(!it);
+    REQUIRE(it.sizeHint() == 0);
+  }
+
+  SUBCASE("loop") {
+    unsigned count = 0;
+    for (auto v : MakeGenerator<Countdown>(10)) {
+      REQUIRE(v == 10 - count);
+      count++;
+    }
+    REQUIRE(count == 11);
+  }
+
+  SUBCASE("collect") {
+    auto values = collect(MakeGenerator<Countdown>(4));
+    REQUIRE(values == std::vector<unsigned>{4, 3, 2, 1, 0});
+    REQUIRE(values.capacity() == 5);
+  }
+
+  SUBCASE("initialized") {
+    struct Empty : InitializedIterable {
+      bool init() { return false; }
+      bool advance() { return true; }
+      int value() { return 0; }
+    };
+    REQUIRE(collect(MakeGenerator<Empty>()).empty());
+  }
+
+  SUBCASE("infinite") {
+    struct Fibonacci {
+      unsigned current = 0, next = 1;
+      void advance() {
+        auto previous = current;
+        current = next;
+        next += previous;
+      }
+      unsigned value() { return current; }
+    };
+    std::vector<unsigned> values;
+    for (auto [i, v] : enumerate(MakeGenerator<Fibonacci>())) {
+      if (i == 7) {
+        break;
+      }
+      values.push_back(v);
+    }
+    REQUIRE(values == std::vector<unsigned>{0, 1, 1, 2, 3, 5, 8});
+  }
+}
+
+TEST_CASE("multi-pass views") {
+  using namespace easy_iterator;
+  std::vector<int> values = {3, 1, 2};
+
+  auto twice = [](auto &&iterable) {
+    std::vector<int> result;
+    for (int pass = 0; pass < 2; ++pass) {
+      for (auto v : iterable) {
+        result.push_back(int(v));
+      }
+    }
+    return result;
+  };
+
+  SUBCASE("range") {
+    auto numbers = range(3);
+    auto copy = numbers;
+    REQUIRE(twice(numbers) == std::vector<int>{0, 1, 2, 0, 1, 2});
+    REQUIRE(twice(copy) == std::vector<int>{0, 1, 2, 0, 1, 2});
+  }
+
+  SUBCASE("zip and enumerate") {
+    std::vector<int> other = {1, 2, 3};
+    auto zipped = zip(values, other);
+    int sum = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+      for (auto [a, b] : zipped) {
+        sum += a * b;
+      }
+    }
+    REQUIRE(sum == 22);
+
+    auto enumerated = enumerate(values);
+    size_t indices = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+      for (auto [i, v] : enumerated) {
+        indices += i;
+        REQUIRE(v == values[i]);
+      }
+    }
+    REQUIRE(indices == 6);
+
+    auto nested = zip(range(3), zipped);
+    size_t count = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+      for (auto [i, pair] : nested) {
+        REQUIRE(std::get<0>(pair) == values[size_t(i)]);
+        ++count;
+      }
+    }
+    REQUIRE(count == 6);
+  }
+
+  SUBCASE("generators") {
+    struct Countdown : public InitializedIterable, public MultiPassIterable {
+      int current;
+      explicit Countdown(int start) : current(start) {}
+      bool init() { return current > 0; }
+      bool advance() { return --current > 0; }
+      int value() { return current; }
+    };
+    MakeIterable<Countdown> iterable(2);
+    REQUIRE(twice(iterable) == std::vector<int>{2, 1, 2, 1});
+    MakeGenerator<Countdown> generator(2);
+    REQUIRE(twice(generator) == std::vector<int>{2, 1, 2, 1});
+
+    // copyable states without the declaration may share a single-pass source
+    struct Reader : public InitializedIterable {
+      std::istream *stream;
+      int current = 0;
+      explicit Reader(std::istream &_stream) : stream(&_stream) {}
+      bool init() { return advance(); }
+      bool advance() { return bool(*stream >> current); }
+      int value() { return current; }
+    };
+    REQUIRE(!MakeIterable<Reader>::multiPass);
+    REQUIRE(!MakeGenerator<Reader>::multiPass);
+    std::istringstream stream("1 2 3");
+    MakeIterable<Reader> reader(stream);
+    size_t count = 0;
+    for (auto v : reader) {
+      REQUIRE(v == int(++count));
+    }
+    REQUIRE(count == 3);
+#if EASY_ITERATOR_DEBUG
+    REQUIRE_THROWS_AS(reader.begin(), ReusedIterableException);
+#endif
+  }
+
+  SUBCASE("combinators") {
+    std::vector<int> a = {1, 3, 5}, b = {2, 3, 4};
+    auto merged = merge(a, b);
+    REQUIRE(twice(merged) == std::vector<int>{1, 2, 3, 3, 4, 5, 1, 2, 3, 3, 4, 5});
+    auto groups = runLength(a);
+    size_t count = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+      for (auto [value, length] : groups) {
+        REQUIRE(length == 1);
+        ++count;
+      }
+    }
+    REQUIRE(count == 6);
+  }
+
+  SUBCASE("traits") {
+    using namespace iterator_detail;
+    REQUIRE(isMultiPass<std::vector<int>::iterator>);
+    REQUIRE(isMultiPass<int *>);
+    REQUIRE(!isMultiPass<std::istream_iterator<int>>);
+    REQUIRE(decltype(range(3))::multiPass);
+    REQUIRE(decltype(zip(values, values))::multiPass);
+    std::istringstream stream("1 2 3");
+    auto numbers = wrap(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+    REQUIRE(!decltype(numbers)::multiPass);
+    REQUIRE(!decltype(zip(numbers, values))::multiPass);
+    REQUIRE(decltype(merge(values, values))::multiPass);
+    REQUIRE(decltype(runLength(values))::multiPass);
+    REQUIRE(decltype(window<2>(values))::multiPass);
+    REQUIRE(!decltype(runLength(numbers))::multiPass);
+    REQUIRE(!decltype(window<2>(numbers))::multiPass);
+    REQUIRE(!decltype(inclusiveScan(numbers))::multiPass);
+    REQUIRE(!decltype(withBudget(numbers, CancellationToken()))::multiPass);
+    REQUIRE(std::vector<int>(numbers.begin(), numbers.end()) == std::vector<int>{1, 2, 3});
+  }
+}
+
+TEST_CASE("windows") {
+  using namespace easy_iterator;
+  std::vector<int> values = {1, 2, 3, 4, 5};
+
+  SUBCASE("contiguous") {
+    std::vector<int> sums;
+    for (auto w : window<3>(values)) {
+      REQUIRE(w.size() == 3);
+      sums.push_back(w[0] + w[1] + w[2]);
+    }
+    REQUIRE(sums == std::vector<int>{6, 9, 12});
+
+    auto first = window<2>(values).begin();
+    REQUIRE((*first).data() == values.data());
+    for (auto w : window<2>(values)) {
+      w.back() -= w.front();
+    }
+    REQUIRE(values == std::vector<int>{1, 1, 2, 2, 3});
+
+    REQUIRE(collect(window<5>(values)).size() == 1);
+    REQUIRE(collect(window<6>(values)).empty());
+    std::vector<int> empty;
+    REQUIRE(collect(window<1>(empty)).empty());
+  }
+
+  SUBCASE("buffered") {
+    struct Counter : public InitializedIterable {
+      int current = 0, max;
+      explicit Counter(int end) : max(end) {}
+      bool init() { return current != max; }
+      bool advance() { return ++current != max; }
+      int value() { return current; }
+    };
+    std::vector<std::vector<int>> windows;
+    for (auto w : window<3>(MakeIterable<Counter>(6))) {
+      windows.emplace_back(w.begin(), w.end());
+    }
+    REQUIRE(windows
+            == std::vector<std::vector<int>>{{0, 1, 2}, {1, 2, 3}, {2, 3, 4}, {3, 4, 5}});
+    REQUIRE(collect(window<4>(MakeIterable<Counter>(3))).empty());
+
+    std::list<std::string> words = {"a", "b", "c"};
+    std::string pairs;
+    for (auto w : window<2>(words)) {
+      pairs += w[0] + w[1];
+    }
+    REQUIRE(pairs == "abbc");
+  }
+
+  SUBCASE("pairwise") {
+    std::vector<int> deltas;
+    for (auto [a, b] : pairwise(values)) {
+      deltas.push_back(b - a);
+    }
+    REQUIRE(deltas == std::vector<int>{1, 1, 1, 1});
+
+    std::istringstream stream("1 4 9 16");
+    auto numbers = wrap(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+    deltas.clear();
+    for (auto [a, b] : pairwise(numbers)) {
+      deltas.push_back(b - a);
+    }
+    REQUIRE(deltas == std::vector<int>{3, 5, 7});
+  }
+
+  SUBCASE("temporary containers") {
+    auto windows = [](auto &&iterable)
+        -> decltype(window<2>(std::forward<decltype(iterable)>(iterable))) {
+      return window<2>(std::forward<decltype(iterable)>(iterable));
+    };
+    auto pairs = [](auto &&iterable)
+        -> decltype(pairwise(std::forward<decltype(iterable)>(iterable))) {
+      return pairwise(std::forward<decltype(iterable)>(iterable));
+    };
+    REQUIRE(std::is_invocable_v<decltype(windows), std::vector<int> &>);
+    REQUIRE(std::is_invocable_v<decltype(windows), decltype(range(3))>);
+    REQUIRE(!std::is_invocable_v<decltype(windows), std::vector<int>>);
+    REQUIRE(std::is_invocable_v<decltype(pairs), std::vector<int> &>);
+    REQUIRE(!std::is_invocable_v<decltype(pairs), std::vector<int>>);
+  }
+}
+
+TEST_CASE("combinatorics") {
+  using namespace easy_iterator;
+  std::vector<int> values = {1, 2, 3, 4};
+
+  auto checkRandomAccess = [](const auto &iterable) {
+    size_t index = 0;
+    for (auto element : iterable) {
+      REQUIRE(element == iterable[index]);
+      REQUIRE(*(iterable.begin() + std::ptrdiff_t(index)) == element);
+      ++index;
+    }
+    REQUIRE(index == iterable.size());
+    REQUIRE(size_t(iterable.end() - iterable.begin()) == iterable.size());
+  };
+
+  SUBCASE("product") {
+    std::vector<std::pair<int, char>> pairs;
+    std::string letters = "ab";
+    for (auto [v, c] : product(range(1, 4), letters)) {
+      pairs.emplace_back(v, c);
+    }
+    REQUIRE(pairs
+            == std::vector<std::pair<int, char>>{
+                {1, 'a'}, {1, 'b'}, {2, 'a'}, {2, 'b'}, {3, 'a'}, {3, 'b'}});
+
+    auto cube = product(values, values, values);
+    REQUIRE(cube.size() == 64);
+    checkRandomAccess(cube);
+    for (auto [a, b, c] : product(values, values, values)) {
+      REQUIRE(&a >= values.data());
+      REQUIRE(&c < values.data() + values.size());
+      (void)b;
+    }
+
+    std::vector<int> empty;
+    REQUIRE(product(values, empty).empty());
+    size_t count = 0;
+    for (auto element : product(values, empty)) {
+      (void)element;
+      ++count;
+    }
+    REQUIRE(count == 0);
+  }
+
+  SUBCASE("combinations") {
+    std::vector<std::tuple<int, int>> pairs;
+    for (auto [a, b] : combinations<2>(values)) {
+      pairs.emplace_back(a, b);
+    }
+    REQUIRE(pairs
+            == std::vector<std::tuple<int, int>>{{1, 2}, {1, 3}, {1, 4}, {2, 3}, {2, 4}, {3, 4}});
+    auto triples = combinations<3>(range(10));
+    REQUIRE(triples.size() == 120);
+    checkRandomAccess(triples);
+    for (auto [a, b, c] : triples) {
+      REQUIRE(a < b);
+      REQUIRE(b < c);
+    }
+    REQUIRE(combinations<5>(values).empty());
+    REQUIRE(combinations<4>(values).size() == 1);
+    if constexpr (sizeof(size_t) == 8) {
+      // close to the largest binomial coefficient representable in 64 bits
+      auto halves = combinations<33>(range(67));
+      REQUIRE(halves.size() == 14226520737620288370ull);
+      REQUIRE(std::get<0>(halves[halves.size() - 1]) == 34);
+      REQUIRE(std::get<32>(halves[halves.size() - 1]) == 66);
+    }
+  }
+
+  SUBCASE("permutations") {
+    std::vector<std::tuple<int, int>> pairs;
+    for (auto [a, b] : permutations<2>(range(3))) {
+      pairs.emplace_back(a, b);
+    }
+    REQUIRE(pairs
+            == std::vector<std::tuple<int, int>>{{0, 1}, {0, 2}, {1, 0}, {1, 2}, {2, 0}, {2, 1}});
+    auto full = permutations<4>(values);
+    REQUIRE(full.size() == 24);
+    checkRandomAccess(full);
+    std::vector<int> current = values;
+    for (auto [a, b, c, d] : full) {
+      REQUIRE(std::vector<int>{a, b, c, d} == current);
+      std::next_permutation(current.begin(), current.end());
+    }
+    REQUIRE(permutations<5>(values).empty());
+  }
+
+  SUBCASE("slices") {
+    auto pairs = combinations<2>(range(100));
+    size_t sum = 0, slices = 7;
+    for (size_t s = 0; s < slices; ++s) {
+      for (auto [a, b] : pairs.slice(pairs.size() * s / slices, pairs.size() * (s + 1) / slices)) {
+        sum += size_t(b - a);
+      }
+    }
+    size_t expected = 0;
+    for (auto [a, b] : pairs) {
+      expected += size_t(b - a);
+    }
+    REQUIRE(sum == expected);
+
+    std::atomic<size_t> parallelSum(0);
+    forEach(
+        execution::par,
+        [&](auto pair) { parallelSum += size_t(std::get<1>(pair) - std::get<0>(pair)); }, pairs);
+    REQUIRE(parallelSum == expected);
+  }
+
+  SUBCASE("seeking") {
+    // bulk algorithms jump to the start of every chunk and step from there
+    struct Counting {
+      using State = size_t;
+      size_t count;
+      std::atomic<size_t> *unranks;
+      size_t size() const { return count; }
+      State unrank(size_t index) const {
+        ++*unranks;
+        return index;
+      }
+      void increment(State &state) const { ++state; }
+      size_t dereference(const State &state) const { return state; }
+    };
+    std::atomic<size_t> unranks(0);
+    IndexedIterable<Counting> indices(Counting{100000, &unranks});
+    std::vector<size_t> target(indices.size());
+    unranks = 0;
+    REQUIRE(copy(execution::par, indices, target));
+    REQUIRE(target[12345] == 12345);
+    REQUIRE(unranks < 100);
+    unranks = 0;
+    REQUIRE(inclusiveScan(execution::par, indices, target) == indices.size());
+    REQUIRE(target.back() == indices.size() * (indices.size() - 1) / 2);
+    REQUIRE(unranks < 100);
+
+    IndexedIterable<Counting>::iterator position;
+    position = indices.begin() + 3;
+    REQUIRE(*position == 3);
+  }
+
+  SUBCASE("overflow") {
+    std::vector<int> large(10000);
+    if constexpr (sizeof(size_t) == 8) {
+      REQUIRE(product(large, large, large, large).size() == 10000000000000000ull);
+    }
+    REQUIRE_THROWS_AS(product(large, large, large, large, large), SizeOverflowException);
+    REQUIRE_THROWS_AS(permutations<20>(range(100)), SizeOverflowException);
+  }
+}
+
+TEST_CASE("bit iteration") {
+  using namespace easy_iterator;
+
+  auto naiveBits = [](const auto &words) {
+    std::vector<size_t> positions;
+    constexpr size_t bits = sizeof(words[0]) * 8;
+    for (size_t i = 0; i < words.size() * bits; ++i) {
+      if ((words[i / bits] >> (i % bits)) & 1) {
+        positions.push_back(i);
+      }
+    }
+    return positions;
+  };
+
+  SUBCASE("words") {
+    REQUIRE(collect(setBits(0b10100101u)) == std::vector<size_t>{0, 2, 5, 7});
+    REQUIRE(collect(setBits(uint64_t(1) << 63)) == std::vector<size_t>{63});
+    REQUIRE(collect(setBits(uint8_t(0xff))).size() == 8);
+    REQUIRE(collect(setBits(0u)).empty());
+    REQUIRE(setBits(0xf0f0u).begin().sizeHint() == 8);
+  }
+
+  SUBCASE("bit vectors") {
+    std::vector<uint8_t> bytes = {0x81, 0, 0x02};
+    REQUIRE(collect(setBits(bytes)) == std::vector<size_t>{0, 7, 17});
+
+    std::vector<uint64_t> words(5);
+    uint64_t state = 12345;
+    for (auto &word : words) {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      word = state & (state >> 17);
+    }
+    words[2] = 0;
+    auto positions = collect(setBits(words));
+    REQUIRE(positions == naiveBits(words));
+    REQUIRE(setBits(words).begin().sizeHint() == positions.size());
+
+    std::vector<uint32_t> empty;
+    REQUIRE(collect(setBits(empty)).empty());
+    std::vector<uint32_t> zeros(3);
+    REQUIRE(collect(setBits(zeros)).empty());
+  }
+
+  SUBCASE("masked values") {
+    std::vector<int> values = {10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    std::vector<uint8_t> mask = {0b00010011, 0xff};
+    REQUIRE(collect(maskedValues(values, mask)) == std::vector<int>{10, 11, 14, 18, 19});
+    REQUIRE(collect(maskedValues(values, 0xffffu)).size() == values.size());
+    REQUIRE(collect(maskedValues(values, uint64_t(1) << 9)) == std::vector<int>{19});
+
+    for (auto &v : maskedValues(values, 0b101u)) {
+      v = 0;
+    }
+    REQUIRE(values[0] == 0);
+    REQUIRE(values[1] == 11);
+    REQUIRE(values[2] == 0);
+
+    std::vector<std::pair<size_t, int>> enumerated;
+    for (auto [i, v] : enumerate(maskedValues(values, mask))) {
+      enumerated.emplace_back(i, v);
+    }
+    REQUIRE(enumerated == std::vector<std::pair<size_t, int>>{{0, 0}, {1, 11}, {2, 14}, {3, 18},
+                                                             {4, 19}});
+  }
+
+  SUBCASE("temporary containers") {
+    using Vector = std::vector<uint32_t>;
+    auto bits = [](auto &&iterable)
+        -> decltype(setBits(std::forward<decltype(iterable)>(iterable))) {
+      return setBits(std::forward<decltype(iterable)>(iterable));
+    };
+    auto masked = [](auto &&...args)
+        -> decltype(maskedValues(std::forward<decltype(args)>(args)...)) {
+      return maskedValues(std::forward<decltype(args)>(args)...);
+    };
+    REQUIRE(std::is_invocable_v<decltype(bits), Vector &>);
+    REQUIRE(!std::is_invocable_v<decltype(bits), Vector>);
+    REQUIRE(std::is_invocable_v<decltype(masked), Vector &, Vector &>);
+    REQUIRE(std::is_invocable_v<decltype(masked), Vector &, unsigned>);
+    REQUIRE(!std::is_invocable_v<decltype(masked), Vector, Vector &>);
+    REQUIRE(!std::is_invocable_v<decltype(masked), Vector &, Vector>);
+  }
+}
+
+TEST_CASE("strided views") {
+  using namespace easy_iterator;
+
+  SUBCASE("channels") {
+    std::vector<int> samples = {0, 10, 20, 1, 11, 21, 2, 12, 22, 3, 13, 23};
+    auto left = channel(samples, 0, 3), right = channel(samples, 2, 3);
+    REQUIRE(left.size() == 4);
+    REQUIRE(std::vector<int>(left.begin(), left.end()) == std::vector<int>{0, 1, 2, 3});
+    REQUIRE(right[3] == 23);
+    REQUIRE(*(right.end() - 2) == 22);
+
+    for (auto [l, r] : zip(left, right)) {
+      r -= l;
+    }
+    REQUIRE(std::vector<int>(right.begin(), right.end()) == std::vector<int>{20, 20, 20, 20});
+
+    std::vector<int> planes[3];
+    for (auto &plane : planes) {
+      plane.resize(4);
+    }
+    deinterleave(samples, planes[0], planes[1], planes[2]);
+    REQUIRE(planes[1] == std::vector<int>{10, 11, 12, 13});
+    REQUIRE(planes[2] == std::vector<int>{20, 20, 20, 20});
+
+    std::vector<int> output(12);
+    interleave(output, planes[0], planes[1], planes[2]);
+    REQUIRE(output == samples);
+
+    std::array<float, 7> odd = {0, 1, 2, 3, 4, 5, 6};
+    REQUIRE(channel(odd, 1, 2).size() == 3);
+    REQUIRE(channel(odd, 1, 2)[2] == 5);
+
+#if EASY_ITERATOR_DEBUG
+    REQUIRE_THROWS_AS(channel(samples, 3, 3), OutOfRangeIteratorException);
+    REQUIRE_THROWS_AS(channel(samples, 0, 0), OutOfRangeIteratorException);
+#endif
+  }
+
+  SUBCASE("columns") {
+    struct Particle {
+      double x, y;
+      int id;
+    };
+    std::vector<Particle> particles = {{0, 1, 7}, {2, 3, 8}, {4, 5, 9}};
+    auto xs = column(particles, &Particle::x);
+    auto ids = column(std::as_const(particles), &Particle::id);
+    REQUIRE(xs.size() == 3);
+    REQUIRE(ids[2] == 9);
+    REQUIRE(std::is_same<decltype(ids[0]), const int &>::value);
+
+    for (auto [x, y] : zip(xs, column(particles, &Particle::y))) {
+      x += y;
+    }
+    REQUIRE(particles[1].x == 5);
+
+    std::vector<double> columnCopy(3);
+    copy(xs, columnCopy);
+    REQUIRE(columnCopy == std::vector<double>{1, 5, 9});
+
+    std::vector<int> sorted(ids.begin(), ids.end());
+    REQUIRE(std::is_sorted(sorted.begin(), sorted.end()));
+    REQUIRE(std::find(ids.begin(), ids.end(), 8) - ids.begin() == 1);
+  }
+
+  SUBCASE("temporary containers") {
+    struct Point {
+      int x, y;
+    };
+    auto channels = [](auto &&iterable)
+        -> decltype(channel(std::forward<decltype(iterable)>(iterable), 0, 2)) {
+      return channel(std::forward<decltype(iterable)>(iterable), 0, 2);
+    };
+    auto columns = [](auto &&iterable)
+        -> decltype(column(std::forward<decltype(iterable)>(iterable), &Point::x)) {
+      return column(std::forward<decltype(iterable)>(iterable), &Point::x);
+    };
+    REQUIRE(std::is_invocable_v<decltype(channels), std::vector<int> &>);
+    REQUIRE(!std::is_invocable_v<decltype(channels), std::vector<int>>);
+    REQUIRE(std::is_invocable_v<decltype(columns), std::vector<Point> &>);
+    REQUIRE(!std::is_invocable_v<decltype(columns), std::vector<Point>>);
+  }
+}
+
+TEST_CASE("compressed columns") {
+  using namespace easy_iterator;
+
+  std::vector<uint64_t> sorted;
+  uint64_t state = 42, current = 1000;
+  for (size_t i = 0; i < 1000; ++i) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    current += (state >> 33) % (i < 500 ? 16 : 100000);
+    sorted.push_back(current);
+  }
+
+  SUBCASE("varints") {
+    std::vector<uint64_t> values = {0, 1, 127, 128, 300, uint64_t(1) << 40, ~uint64_t(0)};
+    auto bytes = encodeVarints(values);
+    REQUIRE(bytes.size() == 1 + 1 + 1 + 2 + 2 + 6 + 10);
+    REQUIRE(collect(varints(bytes)) == values);
+
+    auto deltas = encodeDeltaVarints(sorted);
+    REQUIRE(deltas.size() < encodeVarints(sorted).size());
+    REQUIRE(collect(deltaVarints(deltas)) == sorted);
+    REQUIRE(collect(varints(std::vector<uint8_t>())).empty());
+  }
+
+  SUBCASE("frame of reference") {
+    std::vector<int> values;
+    for (int i = 0; i < 300; ++i) {
+      values.push_back(-50 + (i * 37) % 101);
+    }
+    PackedColumn<int> column(values);
+    REQUIRE(column.size() == values.size());
+    REQUIRE(collect(column) == values);
+    REQUIRE(column.compressedSize() < values.size() * sizeof(int));
+    REQUIRE(collect(column.from(130)) == std::vector<int>(values.begin() + 130, values.end()));
+    REQUIRE(column.from(130).begin().sizeHint() == 170);
+    REQUIRE(collect(column.from(300)).empty());
+
+    int sum = 0;
+    for (auto [a, b] : zip(column, values)) {
+      REQUIRE(a == b);
+      sum += a;
+    }
+    REQUIRE(sum == std::accumulate(values.begin(), values.end(), 0));
+
+    PackedColumn<uint64_t> wide(std::vector<uint64_t>{0, ~uint64_t(0), 5});
+    REQUIRE(collect(wide) == std::vector<uint64_t>{0, ~uint64_t(0), 5});
+    PackedColumn<uint8_t> constant(std::vector<uint8_t>(200, 7));
+    REQUIRE(collect(constant) == std::vector<uint8_t>(200, 7));
+    REQUIRE(collect(PackedColumn<int>()).empty());
+  }
+
+  SUBCASE("delta") {
+    PackedColumn<uint64_t, true> column(sorted);
+    REQUIRE(collect(column) == sorted);
+    REQUIRE(column.compressedSize() < PackedColumn<uint64_t>(sorted).compressedSize());
+
+    for (auto target : {uint64_t(0), sorted[0], sorted[0] + 1, sorted[127], sorted[128],
+                        sorted[500] + 1, sorted.back(), sorted.back() + 1}) {
+      auto expected = std::lower_bound(sorted.begin(), sorted.end(), target) - sorted.begin();
+      auto index = column.lowerBound(target);
+      REQUIRE(index == size_t(expected));
+      if (index < column.size()) {
+        REQUIRE(*column.from(index).begin() == sorted[index]);
+      }
+    }
+  }
+}
+
+TEST_CASE("budgets") {
+  using namespace easy_iterator;
+
+  SUBCASE("cancellation token") {
+    CancellationToken token;
+    size_t count = 0;
+    for (auto i : withBudget(range(1000), token, 10)) {
+      if (i == 25) {
+        token.cancel();
+      }
+      ++count;
+    }
+    REQUIRE(count == 30);
+    REQUIRE(collect(withBudget(range(10), token)).empty());
+    REQUIRE(collect(withBudget(range(10), CancellationToken())).size() == 10);
+  }
+
+  SUBCASE("deadline") {
+    struct Endless {
+      int current = 0;
+      void advance() { ++current; }
+      int value() { return current; }
+    };
+    size_t count = 0;
+    bool ordered = true;
+    for (auto v : withBudget(MakeIterable<Endless>(), std::chrono::milliseconds(5), 64)) {
+      ordered &= v == int(count);
+      ++count;
+    }
+    REQUIRE(ordered);
+    REQUIRE(count > 0);
+    REQUIRE(count % 64 == 0);
+
+    auto past = std::chrono::steady_clock::now();
+    std::vector<int> values(100);
+    REQUIRE(collect(withBudget(values, past)).empty());
+    REQUIRE(collect(withBudget(values, past + std::chrono::hours(1))).size() == 100);
+  }
+
+  SUBCASE("temporary containers") {
+    auto budgeted = [](auto &&iterable)
+        -> decltype(withBudget(std::forward<decltype(iterable)>(iterable), CancellationToken())) {
+      return withBudget(std::forward<decltype(iterable)>(iterable), CancellationToken());
+    };
+    REQUIRE(std::is_invocable_v<decltype(budgeted), std::vector<int> &>);
+    REQUIRE(std::is_invocable_v<decltype(budgeted), decltype(range(3))>);
+    REQUIRE(std::is_invocable_v<decltype(budgeted), execution::ParallelPolicy>);
+    REQUIRE(!std::is_invocable_v<decltype(budgeted), std::vector<int>>);
+  }
+
+  SUBCASE("bulk algorithms") {
+    CancellationToken token;
+    std::vector<int> values(100000, 0);
+    REQUIRE(fill(withBudget(execution::par, token), values, 1));
+    REQUIRE(std::count(values.begin(), values.end(), 1) == 100000);
+
+    token.cancel();
+    REQUIRE(!fill(withBudget(execution::seq, token), values, 2));
+    REQUIRE(std::count(values.begin(), values.end(), 2) == 0);
+
+    CancellationToken stop;
+    std::atomic<size_t> processed(0);
+    auto complete = forEach(
+        withBudget(execution::par, stop, 100),
+        [&](int &v) {
+          if (++processed == 1000) {
+            stop.cancel();
+          }
+          v = 3;
+        },
+        values);
+    REQUIRE(!complete);
+    REQUIRE(processed < values.size());
+    REQUIRE(size_t(std::count(values.begin(), values.end(), 3)) == processed);
+
+    std::list<int> list(1000, 0);
+    CancellationToken listToken;
+    size_t listCount = 0;
+    complete = forEach(
+        withBudget(execution::seq, listToken, 10),
+        [&](int &v) {
+          if (++listCount == 15) {
+            listToken.cancel();
+          }
+          v = 1;
+        },
+        list);
+    REQUIRE(!complete);
+    REQUIRE(listCount == 20);
+
+    std::vector<int> target(100000, 0);
+    REQUIRE(copy(withBudget(execution::par, std::chrono::hours(1)), values, target));
+    REQUIRE(target == values);
+  }
+
+  SUBCASE("completion after the last element") {
+    // a limit expiring during the last block does not leave elements unprocessed
+    std::list<int> list(20, 0);
+    CancellationToken listToken;
+    size_t listCount = 0;
+    auto complete = forEach(
+        withBudget(execution::seq, listToken, 10),
+        [&](int &) {
+          if (++listCount == 20) {
+            listToken.cancel();
+          }
+        },
+        list);
+    REQUIRE(complete);
+    REQUIRE(listCount == 20);
+
+    std::vector<int> values(1000, 0);
+    CancellationToken token;
+    std::vector<int> target(values.size(), 1);
+    complete = copy(
+        withBudget(execution::seq, token, 100), values, target, [&](const int &v) {
+          if (&v == &values.back()) {
+            token.cancel();
+          }
+          return v;
+        });
+    REQUIRE(complete);
+    REQUIRE(token.cancelled());
+    REQUIRE(target == values);
+  }
+}
+
+namespace any_tests {
+  using easy_iterator::AnyIterable;
+
+  int sum(const AnyIterable<int> &values) {
+    int result = 0;
+    for (auto v : values) {
+      result += v;
+    }
+    return result;
+  }
+}  // namespace any_tests
+
+TEST_CASE("AnyIterable") {
+  using namespace easy_iterator;
+  std::vector<int> values(1000);
+  std::iota(values.begin(), values.end(), 0);
+  int expected = std::accumulate(values.begin(), values.end(), 0);
+
+  SUBCASE("sources") {
+    REQUIRE(any_tests::sum(values) == expected);
+    REQUIRE(any_tests::sum(range(1000)) == expected);
+    std::vector<int> empty;
+    REQUIRE(any_tests::sum(empty) == 0);
+    std::list<int> list(values.begin(), values.end());
+    REQUIRE(any_tests::sum(list) == expected);
+
+    struct Countdown : public InitializedIterable {
+      int current = 100;
+      bool init() { return current > 0; }
+      bool advance() { return --current > 0; }
+      int value() { return current; }
+    };
+    REQUIRE(any_tests::sum(MakeIterable<Countdown>()) == 5050);
+    REQUIRE(any_tests::sum(MakeGenerator<Countdown>()) == 5050);
+  }
+
+  SUBCASE("tuples") {
+    std::vector<std::string> names = {"a", "b", "c"};
+    AnyIterable<std::tuple<size_t, std::string>, 2> enumerated = enumerate(names);
+    std::string joined;
+    for (auto &[i, name] : enumerated) {
+      joined += std::to_string(i) + name;
+    }
+    REQUIRE(joined == "0a1b2c");
+    REQUIRE(collect(enumerated).size() == 3);
+  }
+
+  SUBCASE("copies and large states") {
+    std::vector<int> a(10, 1), b(10, 2), c(10, 3), d(10, 4), e(10, 5);
+    AnyIterable<std::tuple<int, int, int, int, int>> zipped = zip(a, b, c, d, e);
+    AnyIterable<std::tuple<int, int, int, int, int>> copy = zipped;
+    size_t count = 0;
+    for (auto [v, w, x, y, z] : copy) {
+      REQUIRE(v + w + x + y + z == 15);
+      ++count;
+    }
+    REQUIRE(count == 10);
+    zipped = std::move(copy);
+    REQUIRE(collect(zipped).size() == 10);
+
+    AnyIterable<int> numbers = values;
+    auto it = numbers.begin();
+    auto other = it;
+    ++it;
+    REQUIRE(*it == 1);
+    REQUIRE(*other == 0);
+  }
+
+  SUBCASE("batches") {
+    AnyIterable<int, 64> numbers = values;
+    std::vector<size_t> sizes;
+    int total = 0;
+    numbers.forEachBatch([&](const int *data, size_t count) {
+      sizes.push_back(count);
+      total = std::accumulate(data, data + count, total);
+    });
+    REQUIRE(total == expected);
+    REQUIRE(sizes.size() == 16);
+    REQUIRE(sizes.back() == 1000 - 15 * 64);
+
+    std::vector<int> exact(128);
+    size_t batches = 0;
+    AnyIterable<int, 64>(exact).forEachBatch([&](const int *, size_t) { ++batches; });
+    REQUIRE(batches == 2);
+  }
+
+  SUBCASE("temporary containers") {
+    REQUIRE(std::is_constructible_v<AnyIterable<int>, std::vector<int> &>);
+    REQUIRE(std::is_constructible_v<AnyIterable<int>, decltype(range(3))>);
+    REQUIRE(!std::is_constructible_v<AnyIterable<int>, std::vector<int>>);
+  }
+}
+
+TEST_CASE("top k") {
+  using namespace easy_iterator;
+  std::vector<int> values(10000);
+  uint64_t state = 7;
+  for (auto &v : values) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    v = int(state >> 40);
+  }
+  auto sorted = values;
+  std::sort(sorted.begin(), sorted.end(), std::greater<>());
+
+  SUBCASE("serial") {
+    REQUIRE(topK(values, 10) == std::vector<int>(sorted.begin(), sorted.begin() + 10));
+    REQUIRE(topK(values, 0).empty());
+    REQUIRE(topK(values, 20000) == sorted);
+    REQUIRE(topK(values, 3, std::greater<>())
+            == std::vector<int>(sorted.rbegin(), sorted.rbegin() + 3));
+
+    std::list<int> list(values.begin(), values.end());
+    REQUIRE(topK(list, 5) == std::vector<int>(sorted.begin(), sorted.begin() + 5));
+    REQUIRE(topK(range(100), 3) == std::vector<int>{99, 98, 97});
+
+    std::vector<int> ascending(1000);
+    std::iota(ascending.begin(), ascending.end(), 0);
+    REQUIRE(topK(ascending, 4) == std::vector<int>{999, 998, 997, 996});
+  }
+
+  SUBCASE("zipped") {
+    std::vector<std::string> names = {"a", "b", "c", "d"};
+    std::vector<double> scores = {0.5, 2, 1, 3};
+    auto byScore = [](const auto &a, const auto &b) { return std::get<1>(a) < std::get<1>(b); };
+    auto best = topK(zip(names, scores), 2, byScore);
+    REQUIRE(best == std::vector<std::tuple<std::string, double>>{{"d", 3}, {"b", 2}});
+    REQUIRE(names == std::vector<std::string>{"a", "b", "c", "d"});
+    REQUIRE(scores == std::vector<double>{0.5, 2, 1, 3});
+  }
+
+  SUBCASE("nth largest") {
+    REQUIRE(nthLargest(values, 0) == sorted[0]);
+    REQUIRE(nthLargest(values, 17) == sorted[17]);
+    REQUIRE(!nthLargest(values, values.size()));
+  }
+
+  SUBCASE("parallel") {
+    std::vector<int> large(100000);
+    for (auto &v : large) {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      v = int(state >> 40);
+    }
+    auto expected = topK(large, 50);
+    REQUIRE(topK(execution::par, large, 50) == expected);
+    REQUIRE(topK(execution::seq, large, 50) == expected);
+    REQUIRE(topK(execution::par, large, 0).empty());
+    std::list<int> list(large.begin(), large.end());
+    REQUIRE(topK(execution::par, list, 50) == expected);
+  }
+
+  SUBCASE("budget") {
+    std::list<int> list(values.begin(), values.end());
+    auto expected = topK(values, 10);
+    CancellationToken token;
+    REQUIRE(topK(withBudget(execution::par, token), values, 10) == expected);
+    REQUIRE(topK(withBudget(execution::seq, token), list, 10) == expected);
+    REQUIRE(topK(withBudget(execution::par, token), values, 0) == std::vector<int>());
+    token.cancel();
+    REQUIRE(!topK(withBudget(execution::par, token), values, 10));
+    REQUIRE(!topK(withBudget(execution::seq, token), list, 10));
+  }
+}
+
+TEST_CASE("scans") {
+  using namespace easy_iterator;
+  std::vector<int> values = {3, 1, 4, 1, 5};
+
+  SUBCASE("lazy") {
+    REQUIRE(collect(inclusiveScan(values)) == std::vector<int>{3, 4, 8, 9, 14});
+    REQUIRE(collect(exclusiveScan(values, size_t(0)))
+            == std::vector<size_t>{0, 3, 4, 8, 9});
+    REQUIRE(collect(inclusiveScan(values, [](int a, int b) { return std::max(a, b); }))
+            == std::vector<int>{3, 3, 4, 4, 5});
+    REQUIRE(collect(exclusiveScan(range(1, 5), std::string(), [](std::string s, int v) {
+              return s + std::to_string(v);
+            }))
+            == std::vector<std::string>{"", "1", "12", "123"});
+    std::vector<int> empty;
+    REQUIRE(collect(inclusiveScan(empty)).empty());
+    auto scanned = inclusiveScan(values);
+    REQUIRE(collect(scanned) == collect(scanned));
+    std::list<int> list(values.begin(), values.end());
+    REQUIRE(collect(exclusiveScan(list, 10)) == std::vector<int>{10, 13, 14, 18, 19});
+  }
+
+  SUBCASE("temporary containers") {
+    auto inclusive = [](auto &&iterable)
+        -> decltype(inclusiveScan(std::forward<decltype(iterable)>(iterable))) {
+      return inclusiveScan(std::forward<decltype(iterable)>(iterable));
+    };
+    auto exclusive = [](auto &&iterable)
+        -> decltype(exclusiveScan(std::forward<decltype(iterable)>(iterable), 0)) {
+      return exclusiveScan(std::forward<decltype(iterable)>(iterable), 0);
+    };
+    REQUIRE(std::is_invocable_v<decltype(inclusive), std::vector<int> &>);
+    REQUIRE(!std::is_invocable_v<decltype(inclusive), std::vector<int>>);
+    REQUIRE(std::is_invocable_v<decltype(exclusive), decltype(range(3))>);
+    REQUIRE(!std::is_invocable_v<decltype(exclusive), std::vector<int>>);
+  }
+
+  SUBCASE("bulk") {
+    std::vector<size_t> offsets(values.size());
+    REQUIRE(exclusiveScan(execution::seq, values, offsets, size_t(0)) == 14);
+    REQUIRE(offsets == std::vector<size_t>{0, 3, 4, 8, 9});
+    inclusiveScan(execution::par, values, values);
+    REQUIRE(values == std::vector<int>{3, 4, 8, 9, 14});
+    std::list<int> list = {1, 2, 3};
+    REQUIRE(exclusiveScan(execution::par, list, list, 1) == 7);
+    REQUIRE(list == std::list<int>{1, 2, 4});
+    std::vector<int> empty;
+    REQUIRE(exclusiveScan(execution::par, empty, empty, 5) == 5);
+  }
+
+  SUBCASE("parallel") {
+    // composition of affine maps is associative but not commutative
+    using Affine = std::pair<uint32_t, uint32_t>;
+    auto compose = [](const Affine &a, const Affine &b) {
+      return Affine(a.first * b.first, a.second * b.first + b.second);
+    };
+    std::vector<Affine> maps(200000);
+    uint32_t state = 1;
+    for (auto &m : maps) {
+      state = state * 1664525u + 1013904223u;
+      m = Affine(state | 1, state >> 7);
+    }
+    std::vector<Affine> expected(maps.size()), result(maps.size());
+    inclusiveScan(execution::seq, maps, expected, compose);
+    REQUIRE(expected == collect(inclusiveScan(maps, compose)));
+    inclusiveScan(execution::par, maps, result, compose);
+    REQUIRE(result == expected);
+
+    std::vector<uint64_t> sizes(300001), offsets(sizes.size());
+    std::iota(sizes.begin(), sizes.end(), 0);
+    REQUIRE(exclusiveScan(execution::par, sizes, offsets, uint64_t(0))
+            == 300000ull * 300001 / 2);
+    for (auto i : range(sizes.size())) {
+      REQUIRE(offsets[i] == i * (i - 1) / 2);
+    }
+    exclusiveScan(execution::par_unseq, sizes, sizes, uint64_t(0));
+    REQUIRE(sizes == offsets);
+  }
+
+  SUBCASE("budget") {
+    std::vector<int> large(100000, 1), result(large.size(), -1);
+    CancellationToken token;
+    token.cancel();
+    REQUIRE(exclusiveScan(withBudget(execution::par, token), large, result, 0) == 0);
+    REQUIRE(result == std::vector<int>(large.size(), -1));
+    CancellationToken active;
+    REQUIRE(exclusiveScan(withBudget(execution::par, active), large, result, 0) == 100000);
+    REQUIRE(result[99999] == 99999);
+    REQUIRE(inclusiveScan(withBudget(execution::par, active), large, result) == large.size());
+    REQUIRE(result[99999] == 100000);
+  }
+
+  SUBCASE("partial budget") {
+    std::vector<int> large(10000, 1), result(large.size(), -1);
+    CancellationToken token;
+    size_t calls = 0;
+    auto stopping = [&](int a, int b) {
+      if (++calls == 2500) {
+        token.cancel();
+      }
+      return a + b;
+    };
+    auto scanned = inclusiveScan(withBudget(execution::seq, token, 1000), large, result, stopping);
+    REQUIRE(scanned == 3000);
+    REQUIRE(result[2999] == 3000);
+    REQUIRE(result[3000] == -1);
+
+    std::list<int> list(100, 1), listResult(100, -1);
+    CancellationToken listToken;
+    calls = 0;
+    auto listStopping = [&](int a, int b) {
+      if (++calls == 15) {
+        listToken.cancel();
+      }
+      return a + b;
+    };
+    REQUIRE(inclusiveScan(withBudget(execution::seq, listToken, 10), list, listResult, listStopping)
+            == 20);
+    REQUIRE(*std::next(listResult.begin(), 19) == 20);
+    REQUIRE(*std::next(listResult.begin(), 20) == -1);
+  }
+}
+
+TEST_CASE("histogram") {
+  using namespace easy_iterator;
+  std::vector<uint8_t> bytes(100000);
+  uint32_t state = 3;
+  for (auto &b : bytes) {
+    state = state * 1664525u + 1013904223u;
+    b = uint8_t(state >> 24);
+  }
+  std::vector<size_t> expected(256);
+  for (auto b : bytes) {
+    ++expected[b];
+  }
+
+  SUBCASE("serial") {
+    REQUIRE(histogram(bytes, 256) == expected);
+    std::list<uint8_t> list(bytes.begin(), bytes.end());
+    REQUIRE(histogram(list, 256) == expected);
+    REQUIRE(histogram(range(10), 2, [](int i) { return i % 2; }) == std::vector<size_t>{5, 5});
+    std::vector<int> same(1001, 3);
+    REQUIRE(histogram(same, 4) == std::vector<size_t>{0, 0, 0, 1001});
+    std::vector<int> none;
+    REQUIRE(histogram(none, 3) == std::vector<size_t>(3));
+  }
+
+  SUBCASE("many bins") {
+    std::vector<size_t> values(5000);
+    std::iota(values.begin(), values.end(), 0);
+    REQUIRE(histogram(values, 5000) == std::vector<size_t>(5000, 1));
+    REQUIRE(histogram(execution::par, values, 5000) == std::vector<size_t>(5000, 1));
+  }
+
+  SUBCASE("zipped") {
+    std::vector<int> a = {0, 1, 1, 0}, b = {1, 1, 0, 1};
+    auto key = [](auto pair) { return size_t(2 * std::get<0>(pair) + std::get<1>(pair)); };
+    REQUIRE(histogram(zip(a, b), 4, key) == std::vector<size_t>{0, 2, 1, 1});
+  }
+
+  SUBCASE("parallel") {
+    REQUIRE(histogram(execution::par, bytes, 256) == expected);
+    REQUIRE(histogram(execution::seq, bytes, 256) == expected);
+    REQUIRE(histogram(withBudget(execution::par, CancellationToken(), 100), bytes, 256)
+            == expected);
+    std::list<uint8_t> list(bytes.begin(), bytes.end());
+    REQUIRE(histogram(execution::par, list, 256) == expected);
+    REQUIRE(histogram(withBudget(execution::seq, CancellationToken(), 100), list, 256)
+            == expected);
+    CancellationToken token;
+    token.cancel();
+    REQUIRE(!histogram(withBudget(execution::par, token), bytes, 256));
+    REQUIRE(!histogram(withBudget(execution::seq, token), list, 256));
+  }
+
+#if EASY_ITERATOR_DEBUG
+  SUBCASE("key out of range") {
+    REQUIRE_THROWS_AS(histogram(bytes, 100), OutOfRangeKeyException);
+  }
+#endif
+}
+
+TEST_CASE("partition") {
+  using namespace easy_iterator;
+  auto check = [](const auto &partitions, const auto &values, size_t fanout, auto key) {
+    REQUIRE(partitions.size() == fanout);
+    REQUIRE(partitions.offsets().back() == values.size());
+    for (auto [bin, part] : enumerate(partitions)) {
+      std::vector<std::decay_t<decltype(*values.begin())>> expected;
+      for (auto &v : values) {
+        if (key(v) == bin) {
+          expected.push_back(v);
+        }
+      }
+      REQUIRE(collect(part) == expected);
+    }
+  };
+
+  SUBCASE("serial") {
+    std::vector<int> values = {5, 2, 7, 0, 3, 2, 9, 4};
+    auto parity = [](int v) { return size_t(v % 2); };
+    auto partitions = partition(values, 2, parity);
+    REQUIRE(collect(partitions[0]) == std::vector<int>{2, 0, 2, 4});
+    REQUIRE(collect(partitions[1]) == std::vector<int>{5, 7, 3, 9});
+    REQUIRE(collect(partitions.values()) == std::vector<int>{2, 0, 2, 4, 5, 7, 3, 9});
+    REQUIRE(partitions.offsets() == std::vector<size_t>{0, 4, 8});
+    for (auto part : partitions) {
+      for (auto &v : part) {
+        v *= 10;
+      }
+    }
+    REQUIRE(collect(partitions[1]) == std::vector<int>{50, 70, 30, 90});
+
+    std::list<int> list(values.begin(), values.end());
+    check(partition(list, 3, [](int v) { return size_t(v % 3); }), values, 3,
+          [](int v) { return size_t(v % 3); });
+    check(partition(range(100), 7, [](int v) { return size_t(v % 7); }),
+          collect(range(100)), 7, [](int v) { return size_t(v % 7); });
+    std::vector<int> empty;
+    auto none = partition(empty, 4);
+    REQUIRE(none.size() == 4);
+    REQUIRE(none.offsets() == std::vector<size_t>(5));
+  }
+
+  SUBCASE("strings") {
+    std::vector<std::string> words = {"pear", "fig", "apple", "kiwi", "banana", "date"};
+    auto byLength = [](const std::string &s) { return s.size() - 3; };
+    auto partitions = partition(words, 4, byLength);
+    check(partitions, words, 4, byLength);
+    REQUIRE(collect(partitions[1]) == std::vector<std::string>{"pear", "kiwi", "date"});
+  }
+
+  SUBCASE("zipped") {
+    std::vector<int> keys = {1, 0, 1, 0};
+    std::vector<std::string> names = {"a", "b", "c", "d"};
+    auto partitions = partition(zip(keys, names), 2, [](auto t) { return size_t(std::get<0>(t)); });
+    REQUIRE(collect(partitions[0])
+            == std::vector<std::tuple<int, std::string>>{{0, "b"}, {0, "d"}});
+    REQUIRE(collect(partitions[1])
+            == std::vector<std::tuple<int, std::string>>{{1, "a"}, {1, "c"}});
+  }
+
+  SUBCASE("radix") {
+    std::vector<uint64_t> values(200000);
+    uint64_t state = 11;
+    for (auto &v : values) {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      v = state;
+    }
+    for (size_t bits : {4, 10}) {
+      auto key = [bits](uint64_t v) { return size_t(v >> (64 - bits)); };
+      size_t fanout = size_t(1) << bits;
+      auto expected = partition(values, fanout, key);
+      check(expected, values, fanout, key);
+      auto parallel = partition(execution::par, values, fanout, key);
+      REQUIRE(parallel.offsets() == expected.offsets());
+      REQUIRE(collect(parallel.values()) == collect(expected.values()));
+      auto budgeted = partition(withBudget(execution::par, CancellationToken(), 1000), values,
+                                fanout, key);
+      REQUIRE(collect(budgeted.values()) == collect(expected.values()));
+      check(partition(std::list<uint64_t>(values.begin(), values.end()), fanout, key), values,
+            fanout, key);
+    }
+  }
+
+  SUBCASE("budget") {
+    std::vector<uint32_t> values(50000);
+    std::iota(values.begin(), values.end(), 0);
+    auto key = [](uint32_t v) { return size_t(v % 256); };
+    CancellationToken token;
+    token.cancel();
+    auto none = partition(withBudget(execution::par, token), values, 256, key);
+    REQUIRE(none.size() == 256);
+    REQUIRE(none.offsets().back() == 0);
+
+    // cancel after the first pass and some blocks of the second pass
+    CancellationToken cancelled;
+    size_t calls = 0;
+    auto stopping = [&](uint32_t v) {
+      if (++calls == 70000) {
+        cancelled.cancel();
+      }
+      return key(v);
+    };
+    auto some = partition(withBudget(execution::seq, cancelled, 1000), values, 256, stopping);
+    std::vector<uint32_t> prefix(values.begin(), values.begin() + 20000);
+    check(some, prefix, 256, key);
+  }
+
+  SUBCASE("budget with strings") {
+    // only the first block is scattered, so its first partition is compacted onto itself
+    std::vector<std::string> words;
+    for (auto i : range(10)) {
+      words.push_back(std::string(20, char('a' + i)) + std::to_string(i));
+    }
+    auto key = [](const std::string &word) { return size_t(word.back() - '0') % 3; };
+    CancellationToken cancelled;
+    size_t calls = 0;
+    auto stopping = [&](const std::string &word) {
+      if (++calls == words.size() + 5) {
+        cancelled.cancel();
+      }
+      return key(word);
+    };
+    auto some = partition(withBudget(execution::seq, cancelled, 5), words, 3, stopping);
+    std::vector<std::string> prefix(words.begin(), words.begin() + 5);
+    check(some, prefix, 3, key);
+    REQUIRE(collect(some[0]) == std::vector<std::string>{words[0], words[3]});
+    REQUIRE(collect(some[2]) == std::vector<std::string>{words[2]});
+  }
+
+#if EASY_ITERATOR_DEBUG
+  SUBCASE("key out of range") {
+    std::vector<int> values = {1, 2, 3};
+    REQUIRE_THROWS_AS(partition(values, 3), OutOfRangeKeyException);
+  }
+#endif
+}